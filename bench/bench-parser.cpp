@@ -0,0 +1,584 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+std::ostream* g_out = &std::cout;
+#define AP_STDOUT (*g_out)
+const char* g_help = nullptr;
+#define AP_HELP g_help
+
+#include "arg-parser-stream.h"
+#include "arg-parser-file.h"
+
+namespace benchargparse {
+namespace {
+
+/* The argv of a case: 'tokens' owns the strings, 'argv' points to them. */
+struct Argv {
+    std::vector<std::string> tokens = { "ap-bench" };
+    std::vector<const char*> argv;
+
+    void push(const std::string& token) { tokens.push_back(token); }
+    int argc() { argv.clear(); for (const std::string& token : tokens) argv.push_back(token.c_str()); return static_cast<int>(argv.size()); }
+};
+
+std::string flagName(const size_t& i) { return "--flag-" + std::to_string(i); }
+std::string flagSpec(const size_t& i) { return "-f" + std::to_string(i) + ", " + flagName(i) + " VALUE"; }
+
+/* PARSE_HELP: copy and split 'size' tokens. */
+void benchParseHelp(Bench& bench, const size_t& size)
+{
+    Argv args;
+    for (size_t i = 1; i < size; ++i)
+        args.push(i % 2 ? flagName(i) + "=" + std::to_string(i) : std::to_string(i));
+    const int argc = args.argc();
+
+    ap::reset();
+    bench.start();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.stop(1);
+}
+
+/* PARSE_FLAG: define 'size' flags of type T, every one of them is given. */
+template <typename T>
+void benchParseFlag(Bench& bench, const size_t& size, const T& def, const std::string& value)
+{
+    Argv args;
+    std::vector<std::string> specs;
+    for (size_t i = 0; i < size; ++i) {
+        specs.push_back(flagSpec(i));
+        args.push(flagName(i));
+        if (!std::is_same<T, bool>::value)
+            args.push(value);
+    }
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    T sum = def;
+    bench.start();
+    for (size_t i = 0; i < size; ++i)
+        sum = PARSE_FLAG(specs[i], def, "flag.");
+    bench.stop(size);
+    (void)sum;
+}
+
+void benchParseFlagInt(Bench& bench, const size_t& size) { benchParseFlag(bench, size, 0, "42"); }
+void benchParseFlagUnsigned(Bench& bench, const size_t& size) { benchParseFlag(bench, size, 0u, "42"); }
+void benchParseFlagFloat(Bench& bench, const size_t& size) { benchParseFlag(bench, size, 0.0f, "3.14"); }
+void benchParseFlagDouble(Bench& bench, const size_t& size) { benchParseFlag(bench, size, 0.0, "3.14"); }
+void benchParseFlagChar(Bench& bench, const size_t& size) { benchParseFlag(bench, size, '.', "x"); }
+void benchParseFlagBool(Bench& bench, const size_t& size) { benchParseFlag(bench, size, false, ""); }
+void benchParseFlagString(Bench& bench, const size_t& size) { benchParseFlag(bench, size, std::string("default"), "a/longer/string/value"); }
+
+/* PARSE_STRUCT: parse 'size' bound int flags in one pass, every one of them is
+ * given. The fields share one member, that does not change the work. */
+struct BenchOptions {
+    int value = 0;
+};
+
+void benchParseStruct(Bench& bench, const size_t& size)
+{
+    Argv args;
+    std::vector<std::string> specs;
+    for (size_t i = 0; i < size; ++i) {
+        specs.push_back(flagSpec(i));
+        args.push(flagName(i));
+        args.push("42");
+    }
+    std::vector<ap::Field<BenchOptions>> fields;
+    for (size_t i = 0; i < size; ++i)
+        fields.push_back(BIND_FLAG(BenchOptions, value, specs[i].c_str(), "flag."));
+    const int argc = args.argc();
+
+    BenchOptions options;
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.start();
+    PARSE_STRUCT(fields, options);
+    bench.stop(size);
+}
+
+/* PARSE_ARG: drain 'size' positional arguments. */
+void benchParseArg(Bench& bench, const size_t& size)
+{
+    Argv args;
+    for (size_t i = 1; i < size; ++i)
+        args.push(std::to_string(i));
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    size_t sum = 0;
+    bench.start();
+    while (UNPARSED_COUNT())
+        sum += PARSE_ARG(0);
+    bench.stop(size - 1);
+    (void)sum;
+}
+
+/* PARSE_LIST: collect the values of a flag repeated among 'size' tokens. */
+template <typename T>
+void benchParseList(Bench& bench, const size_t& size)
+{
+    Argv args;
+    for (size_t i = 1; i + 1 < size; i += 2) {
+        args.push("-I");
+        args.push("include/dir-" + std::to_string(i));
+    }
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.start();
+    const std::vector<T> values = PARSE_LIST("-I, --include DIR", std::vector<T>(), "include dir.");
+    bench.stop(size / 2);
+    (void)values;
+}
+
+void benchParseListString(Bench& bench, const size_t& size) { benchParseList<std::string>(bench, size); }
+void benchParseListView(Bench& bench, const size_t& size) { benchParseList<const char*>(bench, size); }
+
+/* PARSE_MAP: build the map of a 'key=value' flag repeated among 'size'
+ * tokens, the keys are distinct. */
+void benchParseMap(Bench& bench, const size_t& size)
+{
+    Argv args;
+    for (size_t i = 1; i + 1 < size; i += 2) {
+        args.push("-D");
+        args.push("KEY_" + std::to_string(i) + "=" + std::to_string(i));
+    }
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.start();
+    const ap::FlagMap defines = PARSE_MAP("-D, --define KEY=VALUE", "define.");
+    bench.stop(size / 2);
+    (void)defines;
+}
+
+/* A '--ids' value of 'size' comma separated integers. */
+std::string idList(const size_t& size)
+{
+    std::string list;
+    for (size_t i = 0; i < size; ++i)
+        list += (i ? "," : "") + std::to_string(i * 7919 % 1000000);
+    return list;
+}
+
+/* PARSE_SPLIT: split and convert a list of 'size' integers. */
+void benchParseSplit(Bench& bench, const size_t& size)
+{
+    Argv args;
+    args.push("--ids");
+    args.push(idList(size));
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.start();
+    const std::vector<int> ids = PARSE_SPLIT("--ids LIST", std::vector<int>(), "ids.");
+    bench.stop(size, args.tokens.back().size());
+    (void)ids;
+}
+
+/* The same list read as a string and split by a stream. */
+void benchParseSplitStream(Bench& bench, const size_t& size)
+{
+    Argv args;
+    args.push("--ids");
+    args.push(idList(size));
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.start();
+    std::istringstream list(PARSE_FLAG("--ids LIST", std::string(), "ids."));
+    std::vector<int> ids;
+    for (std::string id; std::getline(list, id, ',');)
+        ids.push_back(std::stoi(id));
+    bench.stop(size, args.tokens.back().size());
+}
+
+/* A temporary file of the bytes, it is removed by the destructor. */
+struct TempFile {
+    std::string path;
+
+    explicit TempFile(const std::string& bytes)
+    {
+        char name[] = "/tmp/ap-bench-XXXXXX";
+        const int fd = mkstemp(name);
+        for (size_t done = 0; fd >= 0 && done < bytes.size();) {
+            const ssize_t size = write(fd, bytes.data() + done, bytes.size() - done);
+            if (size <= 0)
+                break;
+            done += static_cast<size_t>(size);
+        }
+        if (fd >= 0)
+            close(fd);
+        path = name;
+    }
+    ~TempFile() { std::remove(path.c_str()); }
+};
+
+/* PARSE_FILE: map a binary file of 'size' doubles and read all of them. */
+void benchParseFileBinary(Bench& bench, const size_t& size)
+{
+    std::vector<double> values(size);
+    for (size_t i = 0; i < size; ++i)
+        values[i] = i * 0.5;
+    const TempFile file(std::string(reinterpret_cast<const char*>(values.data()), size * sizeof(double)));
+    Argv args;
+    args.push("--weights");
+    args.push("@" + file.path);
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.start();
+    const ap::FileArray<double> weights = PARSE_FILE("--weights @PATH", ap::FileArray<double>(), "weights.");
+    double sum = 0.0;
+    for (double weight : weights)
+        sum += weight;
+    bench.stop(size, size * sizeof(double));
+    const volatile double sink = sum;
+    (void)sink;
+}
+
+/* PARSE_FILE: parse a text file of 'size' integers. */
+void benchParseFileText(Bench& bench, const size_t& size)
+{
+    std::string text = idList(size);
+    std::replace(text.begin(), text.end(), ',', '\n');
+    const TempFile file(text);
+    Argv args;
+    args.push("--ids");
+    args.push("@" + file.path);
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    bench.start();
+    const ap::FileArray<int> ids = PARSE_FILE("--ids @PATH", ap::FileArray<int>(ap::FileFormat::Text), "ids.");
+    bench.stop(size, text.size());
+    (void)ids;
+}
+
+/* PARSE_FLAG: the last one of a flag repeated among 'size' tokens wins. */
+void benchParseFlagLast(Bench& bench, const size_t& size)
+{
+    Argv args;
+    for (size_t i = 1; i + 1 < size; i += 2) {
+        args.push("-j");
+        args.push(std::to_string(i));
+    }
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    ap::s_repeat = ap::Repeat::Last;
+    bench.start();
+    const int jobs = PARSE_FLAG("-j, --jobs N", 1, "number of jobs.");
+    bench.stop(size / 2);
+    ap::s_repeat = ap::Repeat::Once;
+    (void)jobs;
+}
+
+/* CHECK_FLAG: look for a missing flag among 'size' tokens. */
+void benchCheckFlag(Bench& bench, const size_t& size)
+{
+    Argv args;
+    for (size_t i = 1; i < size; ++i)
+        args.push(flagName(i));
+    const int argc = args.argc();
+
+    bench.start();
+    const bool found = CHECK_FLAG("-m, --missing", argc, args.argv.data());
+    bench.stop(1);
+    (void)found;
+}
+
+/* Help rendering of 'size' flags. */
+void benchHelp(Bench& bench, const size_t& size)
+{
+    Argv args;
+    args.push("--help");
+    const int argc = args.argc();
+    std::vector<std::string> specs;
+    for (size_t i = 0; i < size; ++i)
+        specs.push_back(flagSpec(i));
+
+    std::ostringstream out;
+    g_out = &out;
+    ap::reset();
+    bench.start();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p [options]\n\nOptions:", argc, args.argv.data());
+    for (size_t i = 0; i < size; ++i)
+        PARSE_FLAG(specs[i], 0, "set the value.\nDefault is '%d'.");
+    bench.stop(size);
+    g_out = &std::cout;
+}
+
+/* Help of 'size' flags from the pre-rendered text, the flags are defined only. */
+void benchHelpEmbedded(Bench& bench, const size_t& size)
+{
+    Argv args;
+    args.push("--help");
+    const int argc = args.argc();
+    std::vector<std::string> specs;
+    for (size_t i = 0; i < size; ++i)
+        specs.push_back(flagSpec(i));
+
+    std::ostringstream out;
+    g_out = &out;
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p [options]\n\nOptions:", argc, args.argv.data());
+    for (size_t i = 0; i < size; ++i)
+        PARSE_FLAG(specs[i], 0, "set the value.\nDefault is '%d'.");
+    const std::string help = out.str();
+
+    out.str("");
+    g_help = help.c_str();
+    ap::reset();
+    bench.start();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p [options]\n\nOptions:", argc, args.argv.data());
+    for (size_t i = 0; i < size; ++i)
+        PARSE_FLAG(specs[i], 0, "set the value.\nDefault is '%d'.");
+    bench.stop(size);
+    g_help = nullptr;
+    g_out = &std::cout;
+}
+
+/* GET_FLAG and handle reads of 'size' defined flags. */
+void benchFlagLookup(Bench& bench, const size_t& size)
+{
+    Argv args;
+    std::vector<std::string> specs;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < size; ++i) {
+        specs.push_back(flagSpec(i));
+        names.push_back(flagName(i));
+        if (i % 10)
+            continue;
+        args.push(names.back());
+        args.push(std::to_string(i));
+    }
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    for (size_t i = 0; i < size; ++i)
+        DEF_FLAG(specs[i], -1, "flag.");
+    size_t sum = 0;
+    bench.start();
+    for (size_t i = 0; i < size; ++i)
+        sum += GET_FLAG(names[i], -1).index;
+    bench.stop(size);
+    (void)sum;
+}
+
+void benchHandleRead(Bench& bench, const size_t& size)
+{
+    Argv args;
+    std::vector<ap::Flag<int>> handles;
+    for (size_t i = 0; i < size; i += 10) {
+        args.push(flagName(i));
+        args.push(std::to_string(i));
+    }
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    for (size_t i = 0; i < size; ++i)
+        handles.push_back(DEF_FLAG(flagSpec(i), -1, "flag."));
+    long long sum = 0;
+    bench.start();
+    for (size_t i = 0; i < size; ++i)
+        sum += handles[i].isSet() ? handles[i].read() : 0;
+    bench.stop(size);
+    (void)sum;
+}
+
+/* '--__complete' query of a long flag prefix in the table of 'size' flags. */
+void benchComplete(Bench& bench, const size_t& size)
+{
+    std::vector<std::string> aliases;
+    for (size_t i = 0; i < size; ++i) {
+        aliases.push_back("-f" + std::to_string(i));
+        aliases.push_back(flagName(i));
+    }
+    std::vector<ap::Completion> table;
+    for (size_t i = 0; i < aliases.size(); ++i)
+        table.push_back({ aliases[i].c_str(), i % 4 < 2 ? "VALUE" : "low|high", "set the value.", false });
+
+    ap::reset();
+    ap::s_help_format = ap::HelpFormat::Complete;
+    ap::s_complete_word = flagName(size - 1);
+    bench.start();
+    const std::string candidates = ap::completeTable(table.data(), table.data() + table.size());
+    bench.stop(1);
+    ap::reset();
+    (void)candidates;
+}
+
+/* Reads of 8 flags by 'size' threads at once: 'read' returns their sum. */
+template <typename Read>
+void benchThreads(Bench& bench, const size_t& size, const Read& read)
+{
+    const size_t reads = 100000;
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < size; ++t)
+        threads.emplace_back([&]() {
+            while (!go.load())
+                std::this_thread::yield();
+            double sum = 0;
+            for (size_t i = 0; i < reads; ++i) {
+                sum += read();
+                clobberMemory();
+            }
+            const volatile double sink = sum;
+            (void)sink;
+        });
+
+    bench.start();
+    go = true;
+    for (std::thread& thread : threads)
+        thread.join();
+    bench.stop(size * reads * 8);
+}
+
+/* Eight flags of mixed types, the first five of them are set. */
+struct ThreadFlags {
+    ap::Flag<int> i;
+    ap::Flag<unsigned> u;
+    ap::Flag<long> l;
+    ap::Flag<float> f;
+    ap::Flag<double> d;
+    ap::Flag<char> c;
+    ap::Flag<bool> b;
+    ap::Flag<size_t> z;
+};
+
+ThreadFlags defineThreadFlags()
+{
+    Argv args;
+    for (const char* token : { "--int=1", "--unsigned=2", "--long=3", "--float=4.5", "-b" })
+        args.push(token);
+    const int argc = args.argc();
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, args.argv.data());
+    ThreadFlags flags;
+    flags.i = DEF_FLAG("-i, --int N", 0, "int.");
+    flags.u = DEF_FLAG("-u, --unsigned N", 0u, "unsigned.");
+    flags.l = DEF_FLAG("-l, --long N", 0l, "long.");
+    flags.f = DEF_FLAG("-f, --float N", 0.0f, "float.");
+    flags.d = DEF_FLAG("-d, --double N", 6.5, "double.");
+    flags.c = DEF_FLAG("-c, --char C", 'c', "char.");
+    flags.b = DEF_FLAG("-b, --bool", false, "bool.");
+    flags.z = DEF_FLAG("-z, --size N", size_t(7), "size.");
+    return flags;
+}
+
+/* Concurrent reads through the flag handles. */
+void benchThreadsHandleRead(Bench& bench, const size_t& size)
+{
+    const ThreadFlags flags = defineThreadFlags();
+    benchThreads(bench, size, [&]() {
+        return flags.i.read() + flags.u.read() + flags.l.read() + flags.f.read()
+            + flags.d.read() + flags.c.read() + flags.b.read() + flags.z.read();
+    });
+}
+
+/* Concurrent reads of a frozen snapshot of the same flags. */
+void benchThreadsSnapshotRead(Bench& bench, const size_t& size)
+{
+    const ThreadFlags flags = defineThreadFlags();
+    const auto snapshot = FREEZE_FLAGS(flags.i, flags.u, flags.l, flags.f, flags.d, flags.c, flags.b, flags.z);
+    benchThreads(bench, size, [&]() {
+        return snapshot.get<0>() + snapshot.get<1>() + snapshot.get<2>() + snapshot.get<3>()
+            + snapshot.get<4>() + snapshot.get<5>() + snapshot.get<6>() + snapshot.get<7>();
+    });
+}
+
+} // namespace anonymous
+} // namespace benchargparse
+
+int main(int argc, char* argv[])
+{
+    using namespace benchargparse;
+
+    BenchConfig config;
+    {
+        const bool help = PARSE_HELP("-h, --help", "show this help.", "Arg-parser benchmarks, results are written as JSON lines.\nUsage: %p [options] [filter]\n\nOptions:", argc, argv);
+        config.maxArgv = PARSE_FLAG("--max-argv N", size_t(1000000), "largest argv length. Default is '%d'.");
+        config.maxFlags = PARSE_FLAG("--max-flags N", size_t(10000), "largest number of flags. Default is '%d'.");
+        config.maxThreads = PARSE_FLAG("--max-threads N", size_t(256), "largest number of reader threads. Default is '%d'.");
+        config.minMs = PARSE_FLAG("--min-time MS", 100.0, "minimal time of a measurement. Default is '%d'.");
+        config.filter = PARSE_ARG(std::string(""));
+        if (help)
+            return 0;
+    }
+
+    const std::vector<BenchCase> cases = {
+        { "parse-help", BenchCase::Argv, benchParseHelp },
+        { "parse-flag-int", BenchCase::Flags, benchParseFlagInt },
+        { "parse-flag-unsigned", BenchCase::Flags, benchParseFlagUnsigned },
+        { "parse-flag-float", BenchCase::Flags, benchParseFlagFloat },
+        { "parse-flag-double", BenchCase::Flags, benchParseFlagDouble },
+        { "parse-flag-char", BenchCase::Flags, benchParseFlagChar },
+        { "parse-flag-bool", BenchCase::Flags, benchParseFlagBool },
+        { "parse-flag-string", BenchCase::Flags, benchParseFlagString },
+        { "parse-struct", BenchCase::Flags, benchParseStruct },
+        { "parse-arg", BenchCase::Argv, benchParseArg },
+        { "parse-list-string", BenchCase::Argv, benchParseListString },
+        { "parse-list-view", BenchCase::Argv, benchParseListView },
+        { "parse-flag-last", BenchCase::Argv, benchParseFlagLast },
+        { "parse-map", BenchCase::Argv, benchParseMap },
+        { "parse-split", BenchCase::Argv, benchParseSplit },
+        { "parse-split-stream", BenchCase::Argv, benchParseSplitStream },
+        { "parse-file-binary", BenchCase::Argv, benchParseFileBinary },
+        { "parse-file-text", BenchCase::Argv, benchParseFileText },
+        { "check-flag", BenchCase::Argv, benchCheckFlag },
+        { "help", BenchCase::Flags, benchHelp },
+        { "help-embedded", BenchCase::Flags, benchHelpEmbedded },
+        { "get-flag", BenchCase::Flags, benchFlagLookup },
+        { "handle-read", BenchCase::Flags, benchHandleRead },
+        { "complete", BenchCase::Flags, benchComplete },
+        { "threads-handle-read", BenchCase::Threads, benchThreadsHandleRead },
+        { "threads-snapshot-read", BenchCase::Threads, benchThreadsSnapshotRead },
+    };
+
+    return runBenches(cases, config, std::cout);
+}
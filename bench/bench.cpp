@@ -0,0 +1,99 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bench.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace benchargparse {
+
+std::atomic<size_t> g_allocations(0);
+
+int runBenches(const std::vector<BenchCase>& cases, const BenchConfig& config, std::ostream& out)
+{
+    const std::vector<size_t> argvSizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+    const std::vector<size_t> flagSizes = { 10, 100, 1000, 5000, 10000 };
+    const std::vector<size_t> threadSizes = { 1, 2, 4, 8, 16, 64, 256 };
+    const char* sweepNames[] = { "argv", "flags", "threads" };
+
+    for (const BenchCase& benchCase : cases) {
+        if (benchCase.name.find(config.filter) == std::string::npos)
+            continue;
+
+        const std::vector<size_t>& sizes = benchCase.sweep == BenchCase::Argv ? argvSizes : benchCase.sweep == BenchCase::Flags ? flagSizes : threadSizes;
+        const size_t maxSize = benchCase.sweep == BenchCase::Argv ? config.maxArgv : benchCase.sweep == BenchCase::Flags ? config.maxFlags : config.maxThreads;
+        for (const size_t& size : sizes) {
+            if (size > maxSize)
+                break;
+
+            Bench bench;
+            size_t runs = 0;
+            while (!runs || bench.ns() < config.minMs * 1e6) {
+                benchCase.func(bench, size);
+                ++runs;
+            }
+
+            out << "{\"case\": \"" << benchCase.name << "\""
+                << ", \"sweep\": \"" << sweepNames[benchCase.sweep] << "\""
+                << ", \"size\": " << size
+                << ", \"runs\": " << runs
+                << ", \"ops\": " << bench.ops()
+                << ", \"ns_per_op\": " << bench.nsPerOp()
+                << ", \"allocs_per_op\": " << bench.allocationsPerOp();
+            if (bench.bytes())
+                out << ", \"gb_per_s\": " << bench.gbPerSecond();
+            out << "}" << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace benchargparse
+
+// Counting allocator.
+
+void* operator new(size_t size)
+{
+    benchargparse::g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
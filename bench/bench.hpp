@@ -0,0 +1,109 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace benchargparse {
+
+/* Keeps the compiler from caching memory reads across the call. */
+inline void clobberMemory()
+{
+#if defined(__GNUC__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+/* Counted by the replaced global 'operator new', which the threads of the
+ * thread sweep call at once. */
+extern std::atomic<size_t> g_allocations;
+
+class Bench {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    void start()
+    {
+        _allocationsAtStart = g_allocations.load(std::memory_order_relaxed);
+        _start = Clock::now();
+    }
+
+    /* The 'bytes' processed by the operations give the throughput. */
+    void stop(const size_t& ops, const size_t& bytes = 0)
+    {
+        _ns += std::chrono::duration<double, std::nano>(Clock::now() - _start).count();
+        _allocations += g_allocations.load(std::memory_order_relaxed) - _allocationsAtStart;
+        _ops += ops;
+        _bytes += bytes;
+    }
+
+    const double& ns() const { return _ns; }
+    const size_t& ops() const { return _ops; }
+    double nsPerOp() const { return _ops ? _ns / _ops : 0.0; }
+    double allocationsPerOp() const { return _ops ? double(_allocations) / _ops : 0.0; }
+    const size_t& bytes() const { return _bytes; }
+    double gbPerSecond() const { return _ns ? _bytes / _ns : 0.0; }
+
+private:
+    Clock::time_point _start;
+    size_t _allocationsAtStart = 0;
+    double _ns = 0.0;
+    size_t _allocations = 0;
+    size_t _ops = 0;
+    size_t _bytes = 0;
+};
+
+/* A case measures its own operations between 'start()' and 'stop()' for the
+ * given size of the swept parameter. */
+struct BenchCase {
+    enum Sweep { Argv, Flags, Threads };
+    typedef void (*BenchFunc)(Bench&, const size_t& size);
+
+    std::string name;
+    Sweep sweep;
+    BenchFunc func;
+};
+
+struct BenchConfig {
+    size_t maxArgv;
+    size_t maxFlags;
+    size_t maxThreads;
+    double minMs;
+    std::string filter;
+};
+
+/* Runs the cases over argv lengths 10..1e6, flag counts 10..1e4 (with 5000
+ * among them) or thread counts 1..256 and writes one JSON object per
+ * measurement. */
+int runBenches(const std::vector<BenchCase>& cases, const BenchConfig& config, std::ostream& out);
+
+} // namespace benchargparse
+
+#endif // BENCH_HPP
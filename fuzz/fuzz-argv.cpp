@@ -0,0 +1,134 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fuzz.hpp"
+
+/* The help output is dropped. */
+#define AP_WRITE(STR) ((void)(STR))
+
+#include "arg-parser.h"
+
+namespace {
+
+/* parseInteger has to convert like convertValue, with or without the bytes
+ * after the token, which the SWAR conversion reads. */
+template <typename T>
+void checkInteger(const std::string& token)
+{
+    T expected = T(7);
+    const bool converted = ap::convertValue(token, expected);
+    const std::string padded = token + "12345678";
+    for (int limit = 0; limit < 2; ++limit) {
+        T result = T(7);
+        FUZZ_CHECK(ap::parseInteger(padded.data(), padded.data() + token.size(), result, limit ? padded.data() + padded.size() : nullptr) == converted);
+        FUZZ_CHECK(!converted || result == expected);
+    }
+}
+
+/* The parts found by matchBytes have to be the ones of a plain search. */
+void checkParts(const std::string& token)
+{
+    std::vector<long> expected;
+    size_t wrongExpected = 0;
+    size_t count = 0;
+    for (size_t begin = 0, end = 0; end != std::string::npos; begin = end + 1, ++count) {
+        end = token.find(',', begin);
+        long value = 0;
+        if (ap::convertValue(token.substr(begin, std::string::npos == end ? std::string::npos : end - begin), value))
+            expected.push_back(value);
+        else
+            ++wrongExpected;
+    }
+    FUZZ_CHECK(ap::countParts(token.data(), token.size(), ',') == count);
+
+    std::vector<long> values(count);
+    size_t wrong = 0;
+    values.resize(ap::convertParts<long>(token.data(), token.size(), token.data() + token.size(), ',', false, values.begin(), wrong));
+    FUZZ_CHECK(values == expected && wrong == wrongExpected);
+}
+
+} // namespace anonymous
+
+/* The input is an argv without the program name, the tokens are separated by
+ * '\0' bytes. Every macro of the parser reads it. */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::vector<std::string> tokens = fuzzargparse::splitInput(data, size, 4096);
+    tokens.insert(tokens.begin(), "ap-fuzz-argv");
+    std::vector<const char*> argv;
+    for (const std::string& token : tokens)
+        argv.push_back(token.c_str());
+    const int argc = static_cast<int>(argv.size());
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p [options] args", argc, argv.data());
+    const int i = PARSE_FLAG("-i, --int", 1, "an int, default: %d");
+    const unsigned u = PARSE_FLAG("-u, --unsigned", 2u, "an unsigned.");
+    const double d = PARSE_FLAG("-d, --double VALUE", 3.0, "a double.");
+    const char c = PARSE_FLAG("-c", 'c', "a char.");
+    const bool b = PARSE_FLAG("-b, --bool", false, "a bool.");
+    const std::string s = PARSE_FLAG("-s, --str TEXT", std::string("str"), "a string\nin two lines.");
+    auto handle = DEF_FLAG("-l, --long", 5l, "a long by handle.");
+    const std::vector<int> ints = PARSE_LIST("-I, --ints N", std::vector<int>({ 6 }), "repeated ints.");
+    const std::vector<long> longs = PARSE_SPLIT("-S, --split LIST", std::vector<long>(), "delimited longs.");
+    const std::vector<std::string> words = PARSE_SPLIT("-W, --words LIST", std::vector<std::string>(), "delimited words.");
+    ap::s_duplicate_key = ap::Duplicate::Reject;
+    const ap::FlagMap defines = PARSE_MAP("-D, --define KEY=VALUE", "a map.");
+    ap::s_duplicate_key = ap::Duplicate::Last;
+    ADD_MSG("See %p.");
+
+    REQUIRE_FLAG("--int");
+    EXCLUDE_FLAGS("-b", "-s");
+    DEPEND_FLAG("-d", "-i", "-u");
+    CHECK_CONSTRAINTS();
+
+    size_t sum = i + u + static_cast<size_t>(d) + c + b + s.size() + handle.read() + handle.isSet();
+    sum += READ_FLAG("-i", 0) + GET_FLAG("--str", std::string()).read().size();
+    sum += ints.size() + defines.size() + longs.size() + words.size();
+    for (const ap::FlagMap::Entry& entry : defines)
+        sum += entry.keySize + std::strlen(entry.value) + defines.contains(std::string(entry.key, entry.keySize));
+    for (size_t n = 0; UNPARSED_COUNT() && n < tokens.size(); ++n)
+        sum += PARSE_ARG(std::string()).size();
+    for (size_t e = 0; e < ERROR_COUNT(); ++e)
+        sum += ERROR_MSG(e).size();
+    sum += CHECK_FLAG("-h, --help", argc, argv.data());
+
+    FUZZ_CHECK(ERROR_COUNT() <= AP_MAX_ERRORS);
+    /* The help returns the defaults without reading the values. */
+    if (!ap::s_help) {
+        FUZZ_CHECK(READ_FLAG("-i, --int", 0) == i);
+        FUZZ_CHECK(READ_FLAG("-l, --long", 0l) == handle.read());
+        FUZZ_CHECK(GET_FLAG("--str", std::string()).read() == s);
+    }
+    for (const std::string& token : tokens) {
+        checkInteger<int>(token);
+        checkInteger<unsigned>(token);
+        checkInteger<long long>(token);
+        checkInteger<unsigned long long>(token);
+        checkParts(token);
+    }
+
+    (void)sum;
+    return 0;
+}
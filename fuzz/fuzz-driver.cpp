@@ -0,0 +1,247 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* A standalone driver for compilers without libFuzzer. It runs the given
+ * corpus files and directories, then mutated inputs until the run or time
+ * limit, and it reports the exec/s and the slowest input like libFuzzer. */
+
+#include "fuzz.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+
+extern "C" void __sanitizer_set_death_callback(void (*)(void)) __attribute__((weak));
+
+namespace fuzzargparse {
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+typedef std::vector<uint8_t> Input;
+
+struct Options {
+    uint64_t runs = 0;
+    uint64_t maxTotalTime = 0;
+    size_t maxLen = 4096;
+    uint64_t seed = 1;
+    std::vector<std::string> paths;
+};
+
+struct Stats {
+    uint64_t execs = 0;
+    uint64_t slowestNs = 0;
+    size_t slowestLen = 0;
+    Clock::time_point start = Clock::now();
+};
+
+Input g_current;
+
+void writeCrash()
+{
+    std::FILE* file = std::fopen("crash-input", "wb");
+    if (!file)
+        return;
+    std::fwrite(g_current.data(), 1, g_current.size(), file);
+    std::fclose(file);
+    std::fprintf(stderr, "The input is written to crash-input (%zu bytes).\n", g_current.size());
+}
+
+/* A failed FUZZ_CHECK aborts, which the sanitizers do not report. */
+void writeAbort(int signal)
+{
+    writeCrash();
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+
+uint64_t nextRandom(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+void readInputs(const std::string& path, std::vector<Input>& inputs)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info))
+        return;
+
+    if (S_ISDIR(info.st_mode)) {
+        DIR* dir = opendir(path.c_str());
+        if (!dir)
+            return;
+        while (dirent* entry = readdir(dir))
+            if (entry->d_name[0] != '.')
+                readInputs(path + "/" + entry->d_name, inputs);
+        closedir(dir);
+        return;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    inputs.push_back(Input(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+}
+
+/* Tokens of the parser, the mutations prefer them to random bytes. */
+const char* const s_tokens[] = { "-", "--", "-h", "--help", "=", ",", " ", "\t", "%p", "%d", "-i", "--int", "-s", "5", "x" };
+
+void mutate(Input& input, uint64_t& state, const size_t& maxLen)
+{
+    const size_t mutations = 1 + nextRandom(state) % 4;
+    for (size_t m = 0; m < mutations; ++m) {
+        const size_t pos = input.empty() ? 0 : nextRandom(state) % (input.size() + 1);
+        switch (nextRandom(state) % 5) {
+        case 0: {
+            const char* token = s_tokens[nextRandom(state) % (sizeof(s_tokens) / sizeof(s_tokens[0]))];
+            input.insert(input.begin() + pos, token, token + std::strlen(token));
+            break;
+        }
+        case 1:
+            input.insert(input.begin() + pos, nextRandom(state) % 4 ? uint8_t(0) : uint8_t(nextRandom(state)));
+            break;
+        case 2:
+            if (pos < input.size())
+                input.erase(input.begin() + pos);
+            break;
+        case 3:
+            if (pos < input.size())
+                input[pos] = uint8_t(nextRandom(state));
+            break;
+        default: {
+            // Duplicate a chunk, so the inputs grow fast towards the limit.
+            const size_t length = input.size() - std::min(pos, input.size());
+            const Input chunk(input.begin() + pos, input.begin() + pos + length);
+            input.insert(input.begin() + pos, chunk.begin(), chunk.end());
+            break;
+        }
+        }
+    }
+    if (input.size() > maxLen)
+        input.resize(maxLen);
+}
+
+void run(const Input& input, Stats& stats)
+{
+    g_current = input;
+    const Clock::time_point start = Clock::now();
+    LLVMFuzzerTestOneInput(g_current.data(), g_current.size());
+    const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    if (ns > stats.slowestNs) {
+        stats.slowestNs = ns;
+        stats.slowestLen = input.size();
+    }
+    ++stats.execs;
+}
+
+void report(const Stats& stats, const char* event)
+{
+    const double seconds = std::chrono::duration<double>(Clock::now() - stats.start).count();
+    std::fprintf(stderr, "#%llu\t%s\texec/s: %.0f\tslowest: %.1f us (len: %zu)\n", (unsigned long long)stats.execs, event,
+        seconds > 0 ? stats.execs / seconds : 0.0, stats.slowestNs / 1000.0, stats.slowestLen);
+}
+
+bool parseOption(const char* arg, const char* name, uint64_t& value)
+{
+    const size_t length = std::strlen(name);
+    if (std::strncmp(arg, name, length))
+        return false;
+    value = std::strtoull(arg + length, nullptr, 10);
+    return true;
+}
+
+} // namespace anonymous
+} // namespace fuzzargparse
+
+int main(int argc, char* argv[])
+{
+    using namespace fuzzargparse;
+
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        uint64_t maxLen = options.maxLen;
+        if (parseOption(argv[i], "-runs=", options.runs) || parseOption(argv[i], "-max_total_time=", options.maxTotalTime)
+            || parseOption(argv[i], "-seed=", options.seed))
+            continue;
+        if (parseOption(argv[i], "-max_len=", maxLen)) {
+            options.maxLen = maxLen;
+            continue;
+        }
+        if (argv[i][0] == '-') {
+            std::fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return 1;
+        }
+        options.paths.push_back(argv[i]);
+    }
+
+    if (__sanitizer_set_death_callback)
+        __sanitizer_set_death_callback(writeCrash);
+    std::signal(SIGABRT, writeAbort);
+
+    std::vector<Input> pool;
+    for (const std::string& path : options.paths)
+        readInputs(path, pool);
+
+    Stats stats;
+    for (const Input& input : pool)
+        run(input, stats);
+    if (!pool.empty())
+        report(stats, "INITED");
+
+    // Without limits only the corpus runs, if there is one.
+    if (!options.paths.empty() && !options.runs && !options.maxTotalTime)
+        return 0;
+
+    if (pool.empty())
+        pool.push_back(Input());
+
+    uint64_t state = options.seed ? options.seed : 1;
+    uint64_t nextReport = 1;
+    for (uint64_t run = 0; !options.runs || run < options.runs; ++run) {
+        Input input = pool[nextRandom(state) % pool.size()];
+        mutate(input, state, options.maxLen);
+        fuzzargparse::run(input, stats);
+
+        if (pool.size() < 256)
+            pool.push_back(input);
+        else if (!(nextRandom(state) % 16))
+            pool[nextRandom(state) % pool.size()] = input;
+
+        if (stats.execs >= nextReport) {
+            report(stats, "pulse");
+            nextReport *= 2;
+        }
+        if (options.maxTotalTime && Clock::now() - stats.start >= std::chrono::seconds(options.maxTotalTime))
+            break;
+    }
+
+    report(stats, "DONE");
+    return 0;
+}
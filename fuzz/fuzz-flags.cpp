@@ -0,0 +1,61 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fuzz.hpp"
+
+#define AP_WRITE(STR) ((void)(STR))
+
+#include "arg-parser.h"
+
+/* The input is a flag spec, it is separated, defined, looked up and checked
+ * against an argv which has its aliases. */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const std::string spec(reinterpret_cast<const char*>(data), size);
+
+    std::vector<std::string> flags;
+    SEPARATE_FLAGS(spec, flags);
+
+    std::vector<std::string> tokens = { "ap-fuzz-flags" };
+    for (const std::string& flag : flags) {
+        tokens.push_back(flag);
+        tokens.push_back("7");
+    }
+    std::vector<const char*> argv;
+    for (const std::string& token : tokens)
+        argv.push_back(token.c_str());
+    const int argc = static_cast<int>(argv.size());
+
+    ap::reset();
+    PARSE_HELP("-h, --help", "show this help.", "Usage: %p", argc, argv.data());
+    size_t sum = PARSE_FLAG(spec, 0, "the spec.");
+    sum += PARSE_FLAG(spec, false, "the spec again as bool.");
+    sum += DEF_FLAG(spec + ", --other", std::string(), "the spec with an alias.").read().size();
+    for (const std::string& flag : flags)
+        sum += GET_FLAG(flag, 0).read() + READ_FLAG(flag, 0);
+    sum += CHECK_FLAG(spec, argc, argv.data());
+
+    (void)sum;
+    return 0;
+}
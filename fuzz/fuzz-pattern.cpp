@@ -0,0 +1,54 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "fuzz.hpp"
+
+#define AP_WRITE(STR) ((void)(STR))
+
+#include "arg-parser.h"
+
+/* The input is a help template, a default value, a pattern and a program name
+ * separated by '\0' bytes. The template is expanded directly and through the
+ * help output too. */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::vector<std::string> parts = fuzzargparse::splitInput(data, size, 4);
+    parts.resize(4);
+    const std::string& msg = parts[0];
+    const std::string& def = parts[1];
+    const std::string& pattern = parts[2];
+
+    const char* argv[] = { parts[3].c_str(), "--help" };
+    const int argc = 2;
+
+    ap::reset();
+    PARSE_HELP("-h, --help", msg, msg, argc, argv);
+    size_t sum = REPLACE_PATTERN(msg, pattern, def).size();
+    sum += PTRNS(msg, def).size();
+    sum += PARSE_FLAG("-f, --flag %d", def, msg).size();
+    ADD_MSG(msg);
+
+    (void)sum;
+    return 0;
+}
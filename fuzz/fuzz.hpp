@@ -0,0 +1,69 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FUZZ_HPP
+#define FUZZ_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/* Every fuzz target defines it, it is called by libFuzzer or by the driver. */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+/* Aborts on a broken invariant, so the fuzzer reports the input. */
+#define FUZZ_CHECK(COND) do { \
+        if (!(COND)) { \
+            std::fprintf(stderr, "%s:%d: FUZZ_CHECK(%s) failed.\n", __FILE__, __LINE__, #COND); \
+            std::abort(); \
+        } \
+    } while (false)
+
+namespace fuzzargparse {
+
+/* Splits the input at the '\0' bytes into at most 'maxParts' strings, the
+ * rest of the input belongs to the last one. */
+inline std::vector<std::string> splitInput(const uint8_t* data, size_t size, const size_t& maxParts)
+{
+    std::vector<std::string> parts;
+    const char* begin = reinterpret_cast<const char*>(data);
+    const char* end = begin + size;
+    while (begin < end && parts.size() + 1 < maxParts) {
+        const char* zero = begin;
+        while (zero < end && *zero)
+            ++zero;
+        parts.push_back(std::string(begin, zero));
+        begin = zero + 1;
+    }
+    if (begin < end)
+        parts.push_back(std::string(begin, end));
+    return parts;
+}
+
+} // namespace fuzzargparse
+
+#endif // FUZZ_HPP
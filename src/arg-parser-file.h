@@ -0,0 +1,224 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ARG_PARSER_FILE_H
+#define ARG_PARSER_FILE_H
+
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "The arg-parser-file.h needs mmap of POSIX."
+#endif // !defined(__unix__) && !defined(__APPLE__)
+
+/*! \brief Define flag of a number array, which is read from the '@path' file or the delimited list of the value */
+#define PARSE_FILE(FLAGS, DEFAULT, MSG) [&](){\
+    /* find value */ size_t index = ap::defineFlag(FLAGS, MSG, false);\
+    /* show help */ if (ap::s_help) { PRINT_FLAG_HELP(index, FLAGS, "", MSG); return DEFAULT; }\
+    /* read values */ return ap::readFile(index, DEFAULT);\
+    }()
+
+#include "arg-parser.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* A text file is parsed by a thread per AP_FILE_CHUNK bytes, at most by one
+ * per core. */
+#if !defined(AP_FILE_CHUNK)
+#define AP_FILE_CHUNK (1 << 20)
+#endif // !defined(AP_FILE_CHUNK)
+
+namespace ap {
+
+/* The '@path' file holds the numbers as raw little endian binary or as
+ * decimal text, one per line. */
+enum class FileFormat : uint8_t { Binary, Text };
+
+/* A read-only span of numbers. The elements of a binary file are its mapped
+ * pages, which are read on demand, the others are parsed into a vector. The
+ * copies share the elements, which are freed with the last one of them. */
+template <typename T>
+class FileArray {
+    static_assert(std::is_arithmetic<T>::value, "The file arrays hold numbers.");
+
+public:
+    explicit FileArray(FileFormat format = FileFormat::Binary)
+        : _format(format)
+        , _data(nullptr)
+        , _size(0)
+    {
+    }
+
+    FileFormat format() const { return _format; }
+    const T* data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return !_size; }
+    const T* begin() const { return _data; }
+    const T* end() const { return _data + _size; }
+    const T& operator[](size_t i) const { return _data[i]; }
+
+    /* Refers to the elements, which are kept by the owner. */
+    void assign(const T* data, size_t size, std::shared_ptr<const void> owner)
+    {
+        _data = data;
+        _size = size;
+        _owner = std::move(owner);
+    }
+
+private:
+    FileFormat _format;
+    const T* _data;
+    size_t _size;
+    std::shared_ptr<const void> _owner;
+};
+
+/* Maps the regular file read-only, its owner unmaps it. Returns null if it
+ * cannot be mapped. A FIFO is not opened for waiting on a writer. */
+inline std::shared_ptr<const void> mapFile(const std::string& path, const char*& data, size_t& size)
+{
+    const int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    std::shared_ptr<const void> owner;
+    struct stat info;
+    if (!fstat(fd, &info) && S_ISREG(info.st_mode)) {
+        size = static_cast<size_t>(info.st_size);
+        data = nullptr;
+        void* address = size ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        if (!size) {
+            owner = std::make_shared<char>(0);
+        } else if (MAP_FAILED != address) {
+            data = static_cast<const char*>(address);
+            owner = std::shared_ptr<const void>(address, [size](const void* pages) { munmap(const_cast<void*>(pages), size); });
+        }
+    }
+    close(fd);
+    return owner;
+}
+
+/* Parses the lines of the text into a vector, which is allocated once: the
+ * chunks of the text end at a line end, their lines are counted and then
+ * converted in parallel, at last the chunks are moved together. The empty
+ * lines are skipped, the number of the wrong ones is returned in 'wrong'. */
+template <typename T>
+std::shared_ptr<std::vector<T>> parseLines(const char* data, size_t size, size_t& wrong)
+{
+    size_t threads = std::thread::hardware_concurrency();
+    if (!threads || threads > size / AP_FILE_CHUNK + 1)
+        threads = size / AP_FILE_CHUNK + 1;
+    std::vector<size_t> bounds(threads + 1, size);
+    bounds[0] = 0;
+    for (size_t i = 1; i < threads; ++i) {
+        const void* end = std::memchr(data + i * (size / threads), '\n', size - i * (size / threads));
+        bounds[i] = end ? static_cast<const char*>(end) - data + 1 : size;
+        if (bounds[i] < bounds[i - 1])
+            bounds[i] = bounds[i - 1];
+    }
+
+    std::vector<size_t> offsets(threads + 1, 0);
+    for (size_t i = 0; i < threads; ++i)
+        offsets[i + 1] = offsets[i] + countParts(data + bounds[i], bounds[i + 1] - bounds[i], '\n');
+    std::shared_ptr<std::vector<T>> values = std::make_shared<std::vector<T>>(offsets[threads]);
+    std::vector<size_t> counts(threads, 0);
+    std::vector<size_t> wrongs(threads, 0);
+    auto convert = [&](size_t i) {
+        counts[i] = convertParts<T>(data + bounds[i], bounds[i + 1] - bounds[i], data + size, '\n', true, values->begin() + offsets[i], wrongs[i]);
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i)
+        workers.emplace_back(convert, i);
+    convert(0);
+    for (size_t i = 0; i < workers.size(); ++i)
+        workers[i].join();
+
+    size_t count = counts[0];
+    wrong = wrongs[0];
+    for (size_t i = 1; i < threads; ++i) {
+        std::copy(values->begin() + offsets[i], values->begin() + offsets[i] + counts[i], values->begin() + count);
+        count += counts[i];
+        wrong += wrongs[i];
+    }
+    values->resize(count);
+    return values;
+}
+
+/* Reads the array of the flag: the mapped or the parsed '@path' file of the
+ * format of the default, or the list of the value split at
+ * 's_list_delimiter'. It returns the default when the flag is not set or the
+ * file cannot be read. A wrong element is recorded in 's_errors' and skipped. */
+template <typename T>
+FileArray<T> readFile(size_t index, const FileArray<T>& def)
+{
+    if (!testBit(s_flags.isSet, index))
+        return def;
+
+    PROFILE_SCOPE(Convert);
+    PROFILE_INDEX(index);
+    const size_t token = s_flags.valueTokens[index];
+    const std::string& value = s_argv[token];
+    FileArray<T> array(def.format());
+    size_t wrong = 0;
+    if ('@' != value[0]) {
+        std::shared_ptr<std::vector<T>> values = std::make_shared<std::vector<T>>(countParts(value.data(), value.size(), s_list_delimiter));
+        values->resize(convertParts<T>(value.data(), value.size(), value.data() + value.size(), s_list_delimiter, false, values->begin(), wrong));
+        array.assign(values->data(), values->size(), values);
+    } else {
+        const char* data = nullptr;
+        size_t size = 0;
+        std::shared_ptr<const void> file = mapFile(value.substr(1), data, size);
+        if (!file || (FileFormat::Binary == def.format() && size % sizeof(T))) {
+            s_errors.push(Error::WrongFile, token, index);
+            return def;
+        }
+        if (FileFormat::Text == def.format()) {
+            std::shared_ptr<std::vector<T>> values = parseLines<T>(data, size, wrong);
+            array.assign(values->data(), values->size(), values);
+        } else {
+#if defined(__BYTE_ORDER__) && __ORDER_BIG_ENDIAN__ == __BYTE_ORDER__
+            /* The bytes of the elements are reversed into a copy. */
+            std::shared_ptr<std::vector<T>> values = std::make_shared<std::vector<T>>(size / sizeof(T));
+            for (size_t i = 0; i < values->size(); ++i) {
+                char bytes[sizeof(T)];
+                for (size_t b = 0; b < sizeof(T); ++b)
+                    bytes[b] = data[(i + 1) * sizeof(T) - 1 - b];
+                std::memcpy(&(*values)[i], bytes, sizeof(T));
+            }
+            array.assign(values->data(), values->size(), values);
+#else
+            array.assign(reinterpret_cast<const T*>(data), size / sizeof(T), file);
+#endif // defined(__BYTE_ORDER__) && __ORDER_BIG_ENDIAN__ == __BYTE_ORDER__
+        }
+    }
+    for (; wrong; --wrong)
+        s_errors.push(Error::WrongValue, token, index);
+    return array;
+}
+
+} // namespace ap
+
+#endif // ARG_PARSER_FILE_H
@@ -0,0 +1,354 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ARG_PARSER_RELOAD_H
+#define ARG_PARSER_RELOAD_H
+
+#if !defined(__linux__)
+#error "The arg-parser-reload.h needs inotify of Linux."
+#endif // !defined(__linux__)
+
+#include "arg-parser.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace ap {
+
+/* Keeps a snapshot of the struct S: the object parsed from the command line
+ * with the flags of a config file on top of it, where the command line wins.
+ * The file is watched by inotify, a reload applies its changed lines only onto
+ * a copy of the last snapshot and publishes the copy by an atomic pointer swap.
+ *
+ * A line of the file is 'FLAG VALUE' or 'FLAG=VALUE' with any alias of the
+ * fields, the first line of a flag wins and a bool flag toggles like on the
+ * command line. Empty lines and lines starting with '#' are skipped. A line
+ * which is removed restores the value of the command line.
+ *
+ * The readers take no lock: a Reader announces the epoch it has seen on every
+ * read, and a replaced snapshot is freed when every reader has passed the
+ * epoch of its replacement. */
+template <typename S>
+class Reloader {
+public:
+    /* The reader of one thread. The snapshot returned by 'read()' is valid
+     * until the next 'read()' or the destruction of the reader. The readers
+     * have to be destroyed before their reloader. */
+    class Reader {
+    public:
+        explicit Reader(Reloader& reloader);
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        void operator=(const Reader&) = delete;
+
+        static void* operator new(size_t size) { return allocateAligned(size, alignof(Reader)); }
+        static void operator delete(void* ptr) { freeAligned(ptr); }
+
+        const S& read()
+        {
+            _seen.store(_reloader._epoch.load());
+            return *_reloader._current.load();
+        }
+
+    private:
+        friend class Reloader;
+
+        Reloader& _reloader;
+        /* Written by its thread only, on its own cache line. */
+        alignas(64) std::atomic<uint64_t> _seen;
+    };
+
+    template <size_t N>
+    Reloader(const Field<S> (&fields)[N], const S& base, const std::string& path)
+        : Reloader(fields, N, base, path)
+    {
+    }
+
+    Reloader(const Field<S>* fields, size_t count, const S& base, const std::string& path);
+    ~Reloader();
+
+    Reloader(const Reloader&) = delete;
+    void operator=(const Reloader&) = delete;
+
+    /* Reads the file and publishes a new snapshot if any value changed. */
+    bool reload();
+    /* Waits for a change of the file at most 'timeoutMs' and reloads it. */
+    bool wait(int timeoutMs);
+
+    /* The inotify descriptor for an event loop, it is readable on changes. */
+    int fd() const { return _inotify; }
+    /* The number of published snapshots. */
+    uint64_t epoch() const { return _epoch.load(); }
+    /* The messages of the last reload. */
+    std::vector<std::string> errors() const
+    {
+        std::lock_guard<std::mutex> lock(_writer);
+        return _errors;
+    }
+
+private:
+    /* The snapshots start and end on their own cache lines. */
+    static S* create(const S& from)
+    {
+        const size_t alignment = alignof(S) > 64 ? alignof(S) : 64;
+        void* ptr = allocateAligned((sizeof(S) + alignment - 1) / alignment * alignment, alignment);
+        try {
+            return new (ptr) S(from);
+        } catch (...) {
+            freeAligned(ptr);
+            throw;
+        }
+    }
+
+    static void destroy(const S* snapshot)
+    {
+        if (!snapshot)
+            return;
+        snapshot->~S();
+        freeAligned(const_cast<S*>(snapshot));
+    }
+
+    void collect();
+
+    const std::vector<Field<S>> _fields;
+    const S _base;
+    const std::string _path;
+    std::string _name;
+    std::unordered_map<std::string, size_t> _aliases;
+    std::vector<bool> _fixed;
+    std::vector<bool> _present;
+    std::vector<std::string> _values;
+    std::vector<std::string> _errors;
+    int _inotify;
+
+    std::atomic<const S*> _current;
+    std::atomic<uint64_t> _epoch;
+    std::vector<std::pair<uint64_t, const S*>> _retired;
+    mutable std::mutex _writer;
+    std::mutex _readersMutex;
+    std::vector<Reader*> _readers;
+};
+
+template <typename S>
+Reloader<S>::Reader::Reader(Reloader& reloader)
+    : _reloader(reloader)
+{
+    std::lock_guard<std::mutex> lock(_reloader._readersMutex);
+    _seen.store(_reloader._epoch.load());
+    _reloader._readers.push_back(this);
+}
+
+template <typename S>
+Reloader<S>::Reader::~Reader()
+{
+    std::lock_guard<std::mutex> lock(_reloader._readersMutex);
+    for (size_t i = 0; i < _reloader._readers.size(); ++i)
+        if (_reloader._readers[i] == this) {
+            _reloader._readers[i] = _reloader._readers.back();
+            _reloader._readers.pop_back();
+            break;
+        }
+}
+
+template <typename S>
+Reloader<S>::Reloader(const Field<S>* fields, size_t count, const S& base, const std::string& path)
+    : _fields(fields, fields + count)
+    , _base(base)
+    , _path(path)
+    , _fixed(count, false)
+    , _present(count, false)
+    , _values(count)
+    , _inotify(-1)
+    , _current(create(base))
+    , _epoch(0)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (!fields[i].spec)
+            continue;
+        std::vector<std::string> aliases;
+        SEPARATE_FLAGS(fields[i].spec, aliases);
+        for (size_t a = 0; a < aliases.size(); ++a)
+            _aliases.insert({ aliases[a], i });
+        /* The flags given on the command line are kept. */
+        const std::string spec(fields[i].spec);
+        _fixed[i] = testBit(s_flags.isSet, s_flags.findSpec(spec, hashToken(spec)));
+    }
+
+    /* Watch the directory, since editors often replace the file. */
+    const size_t slash = path.find_last_of('/');
+    const std::string dir = std::string::npos == slash ? "." : path.substr(0, slash + 1);
+    _name = std::string::npos == slash ? path : path.substr(slash + 1);
+    _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify >= 0 && inotify_add_watch(_inotify, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE) < 0) {
+        close(_inotify);
+        _inotify = -1;
+    }
+
+    reload();
+    if (_inotify < 0)
+        _errors.push_back("Cannot watch '" + path + "'.");
+}
+
+template <typename S>
+Reloader<S>::~Reloader()
+{
+    if (_inotify >= 0)
+        close(_inotify);
+    destroy(_current.load());
+    for (size_t i = 0; i < _retired.size(); ++i)
+        destroy(_retired[i].second);
+}
+
+template <typename S>
+bool Reloader<S>::reload()
+{
+    std::lock_guard<std::mutex> lock(_writer);
+    _errors.clear();
+
+    std::string text;
+    if (std::FILE* file = std::fopen(_path.c_str(), "rb")) {
+        char buffer[4096];
+        for (size_t size; (size = std::fread(buffer, 1, sizeof(buffer), file));)
+            text.append(buffer, size);
+        std::fclose(file);
+    } else {
+        _errors.push_back("Cannot read '" + _path + "'.");
+        return false;
+    }
+
+    std::vector<bool> present(_fields.size(), false);
+    std::vector<std::string> values(_fields.size());
+    std::vector<std::string> keys(_fields.size());
+    std::vector<size_t> lines(_fields.size(), 0);
+    size_t number = 0;
+    for (size_t begin = 0, end = 0; begin < text.size(); begin = end + 1) {
+        end = text.find('\n', begin);
+        if (std::string::npos == end)
+            end = text.size();
+        ++number;
+        std::string line = text.substr(begin, end - begin);
+        if (!line.empty() && '\r' == line[line.size() - 1])
+            line.erase(line.size() - 1);
+        TRIM_SPACES(line);
+        if (line.empty() || '#' == line[0])
+            continue;
+
+        const size_t keyEnd = line.find_first_of(" \t=");
+        const std::string key = line.substr(0, keyEnd);
+        const auto alias = _aliases.find(key);
+        if (alias == _aliases.end()) {
+            _errors.push_back(_path + ":" + std::to_string(number) + ": Unknown flag '" + key + "'.");
+            continue;
+        }
+        const size_t i = alias->second;
+        if (present[i])
+            continue;
+        present[i] = true;
+        keys[i] = key;
+        lines[i] = number;
+        if (std::string::npos != keyEnd) {
+            values[i] = line.substr(keyEnd + 1);
+            TRIM_SPACES(values[i]);
+        }
+    }
+
+    S* next = nullptr;
+    for (size_t i = 0; i < _fields.size(); ++i) {
+        if (_fixed[i] || (present[i] == _present[i] && values[i] == _values[i]))
+            continue;
+        if (!next)
+            next = create(*_current.load());
+        /* A value is read onto the base, so a bool toggles the command line. */
+        _fields[i].copy(_base, *next);
+        if (present[i] && !_fields[i].read(values[i], *next))
+            _errors.push_back(_path + ":" + std::to_string(lines[i]) + ": Wrong value '" + values[i] + "' of flag '" + keys[i] + "'.");
+    }
+    _present.swap(present);
+    _values.swap(values);
+    if (!next)
+        return false;
+
+    /* The epoch is increased after the swap, so a reader which has seen the
+     * new epoch reads the new snapshot. */
+    const S* replaced = _current.exchange(next);
+    _retired.push_back({ ++_epoch, replaced });
+    collect();
+    return true;
+}
+
+template <typename S>
+bool Reloader<S>::wait(int timeoutMs)
+{
+    if (_inotify < 0)
+        return false;
+    pollfd event = { _inotify, POLLIN, 0 };
+    if (poll(&event, 1, timeoutMs) <= 0)
+        return false;
+
+    bool changed = false;
+    alignas(inotify_event) char buffer[4096];
+    for (ssize_t size; (size = ::read(_inotify, buffer, sizeof(buffer))) > 0;) {
+        for (ssize_t offset = 0; offset < size;) {
+            const inotify_event* notify = reinterpret_cast<const inotify_event*>(buffer + offset);
+            if (notify->len && _name == notify->name)
+                changed = true;
+            offset += sizeof(inotify_event) + notify->len;
+        }
+    }
+    return changed && reload();
+}
+
+/* Frees the replaced snapshots which no reader can hold any more. */
+template <typename S>
+void Reloader<S>::collect()
+{
+    uint64_t seen = _epoch.load();
+    {
+        std::lock_guard<std::mutex> lock(_readersMutex);
+        for (size_t i = 0; i < _readers.size(); ++i) {
+            const uint64_t epoch = _readers[i]->_seen.load();
+            if (epoch < seen)
+                seen = epoch;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < _retired.size(); ++i) {
+        if (_retired[i].first <= seen)
+            destroy(_retired[i].second);
+        else
+            _retired[kept++] = _retired[i];
+    }
+    _retired.resize(kept);
+}
+
+} // namespace ap
+
+#endif // ARG_PARSER_RELOAD_H
@@ -0,0 +1,50 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ARG_PARSER_STREAM_H
+#define ARG_PARSER_STREAM_H
+
+#if defined(ARG_PARSER_H) && !defined(AP_STREAM)
+#error "Include arg-parser-stream.h before arg-parser.h."
+#endif // defined(ARG_PARSER_H) && !defined(AP_STREAM)
+
+/*** Interface ***************************************************************/
+
+/*! \brief Stream of the help output */
+#if !defined(AP_STDOUT)
+#define AP_STDOUT std::cout
+#endif // !defined(AP_STDOUT)
+
+/*! \brief Write the help output into AP_STDOUT */
+#if defined(AP_WRITE)
+#undef AP_WRITE
+#endif // defined(AP_WRITE)
+#define AP_WRITE(STR) (AP_STDOUT << (STR))
+
+/*! \brief Convert and format any type which has stream operators */
+#define AP_STREAM
+
+#include "arg-parser.h"
+
+#endif // ARG_PARSER_STREAM_H
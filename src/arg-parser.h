@@ -29,61 +29,2206 @@
 
 /*! \brief Initialize parser and define help flag */
 #define PARSE_HELP(FLAGS, MSG, USAGE, ARGC, ARGV) [&](){\
-    /* copy and setup argv */ for (int i = 0; i < ARGC; ++i) { std::string av = std::string(ARGV[i]); size_t pos = av.find_first_of(ap::s_long_flag_delimiter); if (std::string::npos != pos) { ap::s_argv.push_back(av.substr(0, pos)); av = av.substr(pos + 1); } ap::s_argv.push_back(av); } \
-    /* check help */ if (CHECK_FLAG(FLAGS, ARGC, ARGV)) { ap::s_help = true; AP_STDOUT << PTRNS(USAGE, "") << std::endl; PRINT_HELP(FLAGS, ap::s_help, MSG); } \
+    /* reset values */ ap::AP_CHECK_CONFIG(); ap::clearFlags();\
+    /* copy and setup argv */ { PROFILE_SCOPE(CopyArgv); PROFILE_INDEX(ARGC); for (int i = 0; i < ARGC; ++i) { std::string av = std::string(ARGV[i]); size_t pos = av.find_first_of(ap::s_long_flag_delimiter); if (std::string::npos != pos) { ap::pushToken(av.substr(0, pos)); av = av.substr(pos + 1); } ap::pushToken(std::move(av), std::string::npos != pos); } } \
+    /* check help */ if (ap::startSpecMode(ARGC, ARGV, AP_COMPLETIONS) || CHECK_FLAG(FLAGS, ARGC, ARGV)) { ap::s_help = true; AP_WRITE(ap::helpUsage(USAGE, AP_HELP)); PRINT_HELP(FLAGS, ap::s_help, MSG); } \
     /* parse value */ return ap::s_help;\
     }()
 
 /*! \brief Define flag */
 #define PARSE_FLAG(FLAGS, DEFAULT, MSG) [&](){\
-    /* show help */ if (ap::s_help) { PRINT_HELP(FLAGS, DEFAULT, MSG); return DEFAULT; }\
-    /* parse value */ return [&](){\
-        /* check flag */ size_t j = [&]()->size_t { std::vector<std::string> flags; SEPARATE_FLAGS(FLAGS, flags); for (size_t i = 1; i < ap::s_argv.size(); ++i) for (size_t fi = 0; fi < flags.size(); ++fi) if (ap::s_argv[i] == flags[fi]) return i; return 0; }();\
-        /* parse value */ auto value = DEFAULT; if (j) { if (typeid(DEFAULT) == typeid(bool)) { ap::s_argv.insert(ap::s_argv.begin() + j + 1, (*reinterpret_cast<bool*>(&value) ? "0" : "1")); } if ((++j) < ap::s_argv.size()) { std::string av = std::string(ap::s_argv[j]); std::istringstream iss(av); if (typeid(DEFAULT) == typeid(std::string)) value = *(reinterpret_cast<decltype(DEFAULT)*>(&av)); else iss >> value; ap::s_argv.erase(ap::s_argv.begin() + j); ap::s_argv.erase(ap::s_argv.begin() + j - 1); } }\
-        /* return value */ return value;\
-        }();\
+    /* find value */ size_t index = FIND_VALUE(FLAGS, DEFAULT, MSG);\
+    /* show help */ if (ap::s_help) { PRINT_FLAG_HELP(index, FLAGS, DEFAULT, MSG); return DEFAULT; }\
+    /* read value */ return ap::readValue(index, DEFAULT);\
     }()
 
+/*! \brief Define flag which can be repeated, return the values of its occurrences in order */
+#define PARSE_LIST(FLAGS, DEFAULT, MSG) [&](){\
+    /* find values */ size_t index = ap::defineList(FLAGS, MSG, std::is_same<typename std::decay<decltype(DEFAULT)>::type::value_type, bool>::value);\
+    /* show help */ if (ap::s_help) { PRINT_FLAG_HELP(index, FLAGS, DEFAULT, MSG); return DEFAULT; }\
+    /* read values */ return ap::readList(index, DEFAULT);\
+    }()
+
+/*! \brief Define flag of 'key=value' values, which can be repeated, return the map of them */
+#define PARSE_MAP(FLAGS, MSG) [&](){\
+    /* find values */ size_t index = ap::defineList(FLAGS, MSG, false, true);\
+    /* show help */ if (ap::s_help) { PRINT_FLAG_HELP(index, FLAGS, "", MSG); return ap::FlagMap(); }\
+    /* read values */ return ap::readMap(index);\
+    }()
+
+/*! \brief Define flag of delimited values, which can be repeated, return all of the values in order */
+#define PARSE_SPLIT(FLAGS, DEFAULT, MSG) [&](){\
+    /* find values */ size_t index = ap::defineList(FLAGS, MSG, false);\
+    /* show help */ if (ap::s_help) { PRINT_FLAG_HELP(index, FLAGS, DEFAULT, MSG); return DEFAULT; }\
+    /* read values */ return ap::readSplit(index, DEFAULT);\
+    }()
+
+/*! \brief Read value of an already defined flag, converted once per type */
+#define READ_FLAG(FLAGS, DEFAULT) [&](){\
+    /* read value */ return ap::readValue(ap::defineFlag(FLAGS, "", std::is_same<typename std::decay<decltype(DEFAULT)>::type, bool>::value, false), DEFAULT);\
+    }()
+
+/*! \brief Define flag and return its handle */
+#define DEF_FLAG(FLAGS, DEFAULT, MSG) [&](){\
+    /* find value */ size_t index = FIND_VALUE(FLAGS, DEFAULT, MSG);\
+    /* show help */ if (ap::s_help) PRINT_FLAG_HELP(index, FLAGS, DEFAULT, MSG);\
+    /* return handle */ return ap::flagHandle(index, DEFAULT);\
+    }()
+
+/*! \brief Return handle of a defined flag by one of its names */
+#define GET_FLAG(NAME, DEFAULT) [&](){\
+    /* return handle */ return ap::flagHandle(ap::findFlag(NAME), DEFAULT);\
+    }()
+
+/*! \brief Freeze the values of flag handles into an immutable snapshot, read them by index */
+#define FREEZE_FLAGS(...) ap::freezeFlags(__VA_ARGS__)
+
+/*! \brief Parse flags and arguments into a struct by its table of BIND_FLAG and BIND_ARG fields */
+#define PARSE_STRUCT(FIELDS, OBJECT) [&](){\
+    /* parse tokens */ ap::parseFields(FIELDS, OBJECT);\
+    /* show help */ if (ap::s_help) for (const auto& boundField : FIELDS) if (boundField.spec) PRINT_HELP(boundField.spec, boundField.format(OBJECT), boundField.msg);\
+    }()
+
+/*! \brief Bind flag to a struct member, the current value of the member is the default */
+#define BIND_FLAG(STRUCT, MEMBER, FLAGS, MSG) { FLAGS, MSG, std::is_same<decltype(STRUCT::MEMBER), bool>::value, &ap::readField<AP_MEMBER(STRUCT, MEMBER)>, nullptr, &ap::formatField<AP_MEMBER(STRUCT, MEMBER)>, &ap::copyField<AP_MEMBER(STRUCT, MEMBER)> }
+
+/*! \brief Bind the next argument to a struct member, a vector member takes all the rest */
+#define BIND_ARG(STRUCT, MEMBER) { nullptr, nullptr, false, nullptr, &ap::readArgField<AP_MEMBER(STRUCT, MEMBER)>, nullptr, &ap::copyField<AP_MEMBER(STRUCT, MEMBER)> }
+
+/*! \brief Set flag required */
+#define REQUIRE_FLAG(NAME) ap::requireFlag(NAME)
+
+/*! \brief Set flags mutually exclusive */
+#define EXCLUDE_FLAGS(...) ap::excludeFlags({ __VA_ARGS__ })
+
+/*! \brief Set flag dependent on other flags */
+#define DEPEND_FLAG(NAME, ...) ap::dependFlag(NAME, { __VA_ARGS__ })
+
+/*! \brief Check flag constraints, the flags they name have to be defined by now */
+#define CHECK_CONSTRAINTS() ap::checkConstraints()
+
 /*! \brief Define argument */
 #define PARSE_ARG(DEFAULT) [&](){\
-    /* parse next argument */ auto arg = DEFAULT; if (ap::s_argv.size() > 1) { std::stringstream ss(ap::s_argv[1]); ss >> arg; ap::s_argv.erase(ap::s_argv.begin() + 1); } return arg;\
+    /* parse next argument */ PROFILE_SCOPE(ParseArg); auto arg = DEFAULT; size_t i = ap::firstToken(); PROFILE_INDEX(i); if (i) { ap::readArg(i, arg); ap::parseToken(i); } return arg;\
     }()
 
 /*! \brief Add message */
-#define ADD_MSG(MSG) [&](){ if (ap::s_help) AP_STDOUT << PTRNS(MSG, "") << std::endl; }()
+#define ADD_MSG(MSG) [&](){ if (ap::s_help && ap::HelpFormat::Written != ap::s_help_format) AP_WRITE(ap::helpMessage(MSG)); }()
+
+/*! \brief Return number of stored errors */
+#define ERROR_COUNT() (ap::s_errors.size())
+
+/*! \brief Return message of the i-th error */
+#define ERROR_MSG(I) ap::errorMessage(ap::s_errors[I])
 
 /*! \brief Return number of unparsed arguments */
-#define UNPARSED_COUNT() (ap::s_argv.size() - 1)
+#define UNPARSED_COUNT() (ap::s_argv.size() - 1 - ap::s_parsed_count)
 
 /*! \brief Check flags */
 #define CHECK_FLAG(FLAGS, ARGC, ARGV) [&]()->bool { std::vector<std::string> flags; SEPARATE_FLAGS(FLAGS, flags); for (size_t j = 0; j < flags.size(); ++j) for (int i = 1; i < ARGC; ++i) if (flags[j] == std::string(ARGV[i])) return true; return false; }()
 
-#if !defined(AP_STDOUT)
-#define AP_STDOUT std::cout
-#endif // !defined(AP_STDOUT)
+/*! \brief Write the help output, it goes to stdout without iostreams, see arg-parser-stream.h */
+#if !defined(AP_WRITE)
+#define AP_WRITE(STR) ap::writeOut(STR)
+#endif // !defined(AP_WRITE)
+
+/* AP_TRACE profiles into the trace ring only, unless AP_PROFILE is defined too. */
+#if defined(AP_TRACE) && !defined(AP_PROFILE)
+#define AP_PROFILE
+#define AP_TRACE_ONLY
+#endif // defined(AP_TRACE) && !defined(AP_PROFILE)
+
+/*! \brief Print totals and the slowest records of the parser profile */
+#if defined(AP_PROFILE)
+#define PRINT_PROFILE(COUNT) AP_WRITE(ap::profileReport(COUNT))
+#else
+#define PRINT_PROFILE(COUNT) ((void)(COUNT))
+#endif // defined(AP_PROFILE)
+
+#if defined(AP_TRACE) && !defined(AP_TRACE_EVENTS)
+#define AP_TRACE_EVENTS 4096
+#endif // defined(AP_TRACE) && !defined(AP_TRACE_EVENTS)
+
+#if !defined(AP_MAX_ERRORS)
+#define AP_MAX_ERRORS 16
+#endif // !defined(AP_MAX_ERRORS)
 
 /*** Helpers *****************************************************************/
 
-#include <iostream>
-#include <sstream>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <initializer_list>
+#include <limits>
+#include <new>
 #include <string>
-#include <typeinfo>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
+#if defined(AP_STREAM)
+#include <iostream>
+#include <sstream>
+#endif // defined(AP_STREAM)
+
+#if defined(AP_PROFILE)
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#endif // defined(AP_PROFILE)
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif // defined(_WIN32)
+
+#if defined(AP_TRACE)
+#include <unistd.h>
+#endif // defined(AP_TRACE)
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif // defined(__SSE2__)
+
 namespace ap {
 
-std::vector<std::string> s_argv;
-bool s_help = false;
-int s_alignment = 25;
-std::string s_short_flag_prefixes = "";
-std::string s_long_flag_delimiter = "=";
+/* Flag definitions stored column by column. The hot columns are streamed by
+ * the matching and lookup passes, the cold ones are read by the help and on
+ * hash hits only. The first flag is the never-set wrong flag. */
+struct FlagTable {
+    /* hot */
+    std::vector<uint64_t> aliasHashes;
+    std::vector<size_t> aliasFlags;
+    std::vector<uint64_t> isSet;
+    std::vector<uint64_t> isBool;
+    std::vector<size_t> flagTokens;
+    std::vector<size_t> valueTokens;
+    /* cold */
+    std::vector<std::string> aliases;
+    std::vector<std::string> specs;
+    std::vector<uint64_t> specHashes;
+    std::vector<std::string> messages;
+    /* flags by spec hash with linear probing, zero is empty */
+    std::vector<size_t> specSlots;
+    /* aliases plus one by alias hash with linear probing, zero is empty */
+    std::vector<size_t> aliasSlots;
+    /* value tokens of the list flags, a range per list ends at its pair */
+    std::vector<size_t> listTokens;
+    std::vector<std::pair<size_t, size_t>> lists;
+
+    FlagTable() { clear(); }
+
+    size_t size() const { return valueTokens.size(); }
+    void clear()
+    {
+        aliasHashes.clear();
+        aliasFlags.clear();
+        isSet.assign(1, 0);
+        isBool.assign(1, 0);
+        flagTokens.assign(1, 0);
+        valueTokens.assign(1, 0);
+        aliases.clear();
+        specs.assign(1, "");
+        specHashes.assign(1, 0);
+        messages.assign(1, "");
+        specSlots.clear();
+        aliasSlots.clear();
+        listTokens.clear();
+        lists.clear();
+    }
+
+    /* Returns the flag of the spec or the wrong flag. */
+    size_t findSpec(const std::string& spec, uint64_t hash) const
+    {
+        const size_t mask = specSlots.size() - 1;
+        for (size_t slot = hash & mask; !specSlots.empty() && specSlots[slot]; slot = (slot + 1) & mask)
+            if (specHashes[specSlots[slot]] == hash && specs[specSlots[slot]] == spec)
+                return specSlots[slot];
+        return 0;
+    }
+
+    /* Adds the last flag to the slots, they are kept at most half full. A
+     * redefined spec takes the slot of its previous flag. */
+    void indexSpec()
+    {
+        if (specSlots.size() < 2 * size()) {
+            specSlots.assign(specSlots.empty() ? 16 : 2 * specSlots.size(), 0);
+            for (size_t flag = 1; flag + 1 < size(); ++flag)
+                insertSlot(flag);
+        }
+        insertSlot(size() - 1);
+    }
+
+    void insertSlot(size_t flag)
+    {
+        const size_t mask = specSlots.size() - 1;
+        size_t slot = specHashes[flag] & mask;
+        while (specSlots[slot] && !(specHashes[specSlots[slot]] == specHashes[flag] && specs[specSlots[slot]] == specs[flag]))
+            slot = (slot + 1) & mask;
+        specSlots[slot] = flag;
+    }
+
+    /* Returns the flag of the last defined alias or the wrong flag. */
+    size_t findAlias(const std::string& alias, uint64_t hash) const
+    {
+        const size_t mask = aliasSlots.size() - 1;
+        for (size_t slot = hash & mask; !aliasSlots.empty() && aliasSlots[slot]; slot = (slot + 1) & mask) {
+            const size_t a = aliasSlots[slot] - 1;
+            if (aliasHashes[a] == hash && aliases[a] == alias)
+                return aliasFlags[a];
+        }
+        return 0;
+    }
+
+    /* Adds the last alias to the slots like 'indexSpec()', an alias defined
+     * again takes the slot of its previous one. */
+    void indexAlias()
+    {
+        if (aliasSlots.size() < 2 * aliases.size()) {
+            aliasSlots.assign(aliasSlots.empty() ? 16 : 2 * aliasSlots.size(), 0);
+            for (size_t a = 0; a + 1 < aliases.size(); ++a)
+                insertAlias(a);
+        }
+        insertAlias(aliases.size() - 1);
+    }
+
+    void insertAlias(size_t a)
+    {
+        const size_t mask = aliasSlots.size() - 1;
+        size_t slot = aliasHashes[a] & mask;
+        while (aliasSlots[slot] && !(aliasHashes[aliasSlots[slot] - 1] == aliasHashes[a] && aliases[aliasSlots[slot] - 1] == aliases[a]))
+            slot = (slot + 1) & mask;
+        aliasSlots[slot] = a + 1;
+    }
+};
+
+/* Rows of flag bitsets stored one after the other, each row belongs to a flag. */
+struct BitMatrix {
+    std::vector<uint64_t> bits;
+    std::vector<size_t> rowEnds;
+    std::vector<size_t> rowFlags;
+
+    size_t rows() const { return rowFlags.size(); }
+    size_t rowBegin(size_t row) const { return row ? rowEnds[row - 1] : 0; }
+    void clear()
+    {
+        bits.clear();
+        rowEnds.clear();
+        rowFlags.clear();
+    }
+};
+
+/* Constraints declared by flag names, a rule refers to the range of its
+ * names, where the first name of a dependency is its owner. They are compiled
+ * over the flag indices when they are checked: 'required' is a bitset, an
+ * 'exclusive' row is a group of flags from which at most one can be set, and
+ * a 'dependencies' row lists the flags its owner flag requires. They are
+ * compiled again only if a rule or a flag is added since the last check,
+ * and a name which is not defined is reported once. */
+struct Constraints {
+    struct Rule {
+        enum Kind : uint8_t { Require, Exclude, Depend };
+        Kind kind;
+        size_t first;
+        size_t last;
+    };
+    std::vector<std::string> names;
+    std::vector<Rule> rules;
+    std::vector<uint64_t> required;
+    BitMatrix exclusive;
+    BitMatrix dependencies;
+    std::vector<uint64_t> reportedNames;
+    size_t compiledRules = 0;
+    size_t compiledFlags = 0;
+    bool resolved = true;
+
+    void clear()
+    {
+        names.clear();
+        rules.clear();
+        required.clear();
+        exclusive.clear();
+        dependencies.clear();
+        reportedNames.clear();
+        compiledRules = 0;
+        compiledFlags = 0;
+        resolved = true;
+    }
+};
+
+/* An error is recorded by its token and flag indices only, the message is
+ * built on demand by 'errorMessage()'. A zero token means no token. The flag
+ * of an unknown flag is the index of its name in the constraints. */
+struct Error {
+    enum Code : uint8_t { WrongValue = 1, MissingFlag, ExclusiveFlag, MissingDependency, DuplicateKey, WrongFile, UnknownFlag };
+    Code code;
+    uint32_t token;
+    uint32_t flag;
+};
+
+/* Keeps the first AP_MAX_ERRORS errors without allocation, the later ones
+ * are counted only. */
+struct ErrorBuffer {
+    Error data[AP_MAX_ERRORS];
+    size_t count;
+
+    size_t size() const { return count < AP_MAX_ERRORS ? count : AP_MAX_ERRORS; }
+    size_t dropped() const { return count - size(); }
+    const Error& operator[](size_t i) const { return data[i]; }
+    void push(Error::Code code, size_t token, size_t flag)
+    {
+        if (count < AP_MAX_ERRORS)
+            data[count] = { code, static_cast<uint32_t>(token), static_cast<uint32_t>(flag) };
+        ++count;
+    }
+    void clear() { count = 0; }
+};
+
+/* How the repeated occurrences of a flag are parsed: only the first one, so
+ * the later ones are left for the arguments, or every one of them, where
+ * the first or the last one gives the value. */
+enum class Repeat : uint8_t { Once, First, Last };
+
+/* Which value of a repeated key of a map flag is kept: the last or the
+ * first one, or the first one and the later ones are errors. */
+enum class Duplicate : uint8_t { Last, First, Reject };
+
+/* The output of the help mode: the help text, nothing after a pre-rendered
+ * help is written, or the spec modes of the reserved '--__*' first arguments,
+ * see 'startSpecMode()'. */
+enum class HelpFormat : uint8_t { Text, Written, Complete, CompletionTable, CompletionScript, HelpBlob, Man, Markdown };
+
+/* A flag alias of the completion table. The value is the name of the value
+ * in the spec, where 'a|b|c' lists its choices. */
+struct Completion {
+    const char* alias;
+    const char* value;
+    const char* brief;
+    bool isBool;
+};
 
-#define SEPARATE_FLAGS(FLAGS, ARRAY) [&](){ std::stringstream ss(FLAGS); std::string flag; while (std::getline(ss, flag, ',')) { TRIM_SPACES(flag); ARRAY.push_back(flag);} std::string& lastFlag = ARRAY.back(); size_t pos = lastFlag.find_last_of(" \t"); if (std::string::npos != pos) TRIM_SPACES(lastFlag.erase(pos)); }()
-#define PRINT_HELP(FLAGS, DEFAULT, MSG) [&](){ std::stringstream defStream; defStream << DEFAULT; std::string flags = PTRNS(FLAGS, defStream.str()); int size = ap::s_alignment - std::string(flags).size() - 2; AP_STDOUT << "  " << flags; std::stringstream msgStream(PTRNS(MSG, defStream.str())); std::string msg; bool first = true; while (std::getline(msgStream, msg, '\n')) { AP_STDOUT << std::string(first ? (size > 1 ? size : 2) : ap::s_alignment, ' ') << msg.erase(0, std::min(msg.find_first_not_of(' '), msg.size())) << std::endl; first = false; } }()
-#define REPLACE_PATTERN(MSG, PTRN, VALUE) [&](){ std::string str(MSG); std::string ptrn(PTRN); while (str.find(ptrn) < str.size()) str.replace(str.find(ptrn), ptrn.length(), std::string(VALUE)); return str; }()
+/* With AP_LIBRARY the state and the engine are compiled once into the
+ * arg-parser library (arg-parser.cpp), so any number of translation units can
+ * include the header. Otherwise the header defines them and it can be included
+ * into one translation unit only. */
+#if defined(AP_LIBRARY) && !defined(AP_IMPLEMENTATION)
+#define AP_STATE(TYPE, NAME, INIT) extern TYPE NAME
+#define AP_ENGINE
+#elif defined(AP_LIBRARY)
+#define AP_STATE(TYPE, NAME, INIT) TYPE NAME = INIT
+#define AP_ENGINE
+#else
+#define AP_STATE(TYPE, NAME, INIT) TYPE NAME = INIT
+#define AP_ENGINE inline
+#endif // defined(AP_LIBRARY) && !defined(AP_IMPLEMENTATION)
+
+/* The options which change the state are put into the name of a function,
+ * which PARSE_HELP calls. The library defines the one of its own options, so
+ * an includer with other options fails to link instead of sharing a state of
+ * another layout. AP_MAX_ERRORS and AP_TRACE_EVENTS are integer literals. */
+#if defined(AP_TRACE_ONLY)
+#define AP_CONFIG_PROFILE traceonly
+#elif defined(AP_PROFILE)
+#define AP_CONFIG_PROFILE profile
+#else
+#define AP_CONFIG_PROFILE noprofile
+#endif // defined(AP_TRACE_ONLY)
+#if defined(AP_TRACE)
+#define AP_CONFIG_TRACE AP_TRACE_EVENTS
+#else
+#define AP_CONFIG_TRACE 0
+#endif // defined(AP_TRACE)
+#define AP_CONFIG_NAME_(ERRORS, PROFILE, TRACE) checkConfig_errors##ERRORS##_##PROFILE##_trace##TRACE
+#define AP_CONFIG_NAME(ERRORS, PROFILE, TRACE) AP_CONFIG_NAME_(ERRORS, PROFILE, TRACE)
+#define AP_CHECK_CONFIG AP_CONFIG_NAME(AP_MAX_ERRORS, AP_CONFIG_PROFILE, AP_CONFIG_TRACE)
+
+AP_ENGINE void AP_CHECK_CONFIG();
+
+AP_STATE(std::vector<std::string>, s_argv, {});
+AP_STATE(std::vector<uint64_t>, s_argv_hashes, {});
+AP_STATE(std::vector<uint64_t>, s_argv_parsed, {});
+AP_STATE(std::vector<uint64_t>, s_argv_joined, {});
+AP_STATE(size_t, s_parsed_count, 0);
+AP_STATE(size_t, s_first_token, 1);
+AP_STATE(FlagTable, s_flags, {});
+AP_STATE(Constraints, s_constraints, {});
+const size_t s_wrong_flag = 0;
+AP_STATE(ErrorBuffer, s_errors, {});
+AP_STATE(size_t, s_generation, 0);
+AP_STATE(bool, s_help, false);
+AP_STATE(int, s_alignment, 25);
+AP_STATE(std::string, s_short_flag_prefixes, "");
+AP_STATE(std::string, s_long_flag_delimiter, "=");
+AP_STATE(Repeat, s_repeat, Repeat::Once);
+AP_STATE(Duplicate, s_duplicate_key, Duplicate::Last);
+AP_STATE(char, s_list_delimiter, ',');
+AP_STATE(HelpFormat, s_help_format, HelpFormat::Text);
+AP_STATE(std::string, s_complete_word, "");
+AP_STATE(std::string, s_complete_prev, "");
+AP_STATE(std::vector<std::string>, s_completed_aliases, {});
+AP_STATE(bool, s_help_header, false);
+
+/* The table generated by '--__complete-table' (a build step, see
+ * src/CMakeLists.txt) is compiled into the program by defining its path in
+ * AP_COMPLETION_TABLE, then '--__complete' answers from it. */
+#if defined(AP_COMPLETION_TABLE)
+static const Completion s_completion_table[] = {
+#include AP_COMPLETION_TABLE
+};
+#define AP_COMPLETIONS ap::s_completion_table, ap::s_completion_table + sizeof(ap::s_completion_table) / sizeof(ap::s_completion_table[0])
+#else
+#define AP_COMPLETIONS nullptr, nullptr
+#endif // defined(AP_COMPLETION_TABLE)
+
+/* The help generated by '--__help-blob' is compiled into the program by
+ * defining its path in AP_HELP_TEXT, or AP_HELP can be any pre-rendered help
+ * where '%p' is the program. Then PARSE_HELP writes it at once and the
+ * definitions write nothing. */
+#if defined(AP_HELP_TEXT)
+static const char s_help_text[] =
+#include AP_HELP_TEXT
+;
+#define AP_HELP ap::s_help_text
+#elif !defined(AP_HELP)
+#define AP_HELP nullptr
+#endif // defined(AP_HELP_TEXT)
+
+#if defined(AP_PROFILE)
+/* A profiled phase. The index is the flag, the token for ParseArg, the
+ * number of arguments for CopyArgv and the number of errors for Validate.
+ * The generation is the one of its PARSE_HELP. */
+struct ProfileRecord {
+    enum Phase : uint8_t { CopyArgv, Lookup, Convert, ParseArg, Help, Validate, PhaseCount };
+    Phase phase;
+    size_t index;
+    uint64_t ns;
+    uint64_t allocations;
+    size_t generation;
+};
+
+/* Counted by the replaced 'operator new' of any thread. */
+AP_STATE(std::atomic<size_t>, s_profile_allocations, { 0 });
+AP_STATE(std::vector<ProfileRecord>, s_profile, {});
+
+#if defined(AP_TRACE)
+AP_ENGINE void writeTrace();
+
+/* The last AP_TRACE_EVENTS profile records with their start time, kept in a
+ * preallocated ring. It is enabled by the AP_TRACE_FILE environment variable
+ * and written there as Chrome trace-event JSON on exit. With AP_TRACE alone
+ * the records go into the ring only, and nothing is measured without the
+ * variable. */
+struct TraceRing {
+    struct Event {
+        ProfileRecord record;
+        uint64_t start;
+    } events[AP_TRACE_EVENTS];
+    size_t count;
+    const char* path;
+
+    TraceRing() : count(0), path(std::getenv("AP_TRACE_FILE")) {}
+    ~TraceRing() { writeTrace(); }
+
+    void push(const ProfileRecord& record, uint64_t start) { events[count++ % AP_TRACE_EVENTS] = { record, start }; }
+};
+
+AP_STATE(TraceRing, s_trace, {});
+#endif // defined(AP_TRACE)
+
+class ProfileScope {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit ProfileScope(ProfileRecord::Phase phase)
+        : _phase(phase)
+        , _allocations(s_profile_allocations.load(std::memory_order_relaxed))
+        , _start(enabled() ? Clock::now() : Clock::time_point())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (!enabled())
+            return;
+        const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+        const ProfileRecord record = { _phase, index, ns, s_profile_allocations.load(std::memory_order_relaxed) - _allocations, s_generation };
+#if !defined(AP_TRACE_ONLY)
+        s_profile.push_back(record);
+#endif // !defined(AP_TRACE_ONLY)
+#if defined(AP_TRACE)
+        if (s_trace.path)
+            s_trace.push(record, std::chrono::duration_cast<std::chrono::nanoseconds>(_start.time_since_epoch()).count());
+#endif // defined(AP_TRACE)
+    }
+
+    static bool enabled()
+    {
+#if defined(AP_TRACE_ONLY)
+        return s_trace.path;
+#else
+        return true;
+#endif // defined(AP_TRACE_ONLY)
+    }
+
+    size_t index = 0;
+
+private:
+    const ProfileRecord::Phase _phase;
+    const size_t _allocations;
+    const Clock::time_point _start;
+};
+
+#define PROFILE_SCOPE(PHASE) ap::ProfileScope profileScope(ap::ProfileRecord::PHASE)
+#define PROFILE_INDEX(INDEX) profileScope.index = static_cast<size_t>(INDEX)
+#else
+#define PROFILE_SCOPE(PHASE)
+#define PROFILE_INDEX(INDEX)
+#endif // defined(AP_PROFILE)
+
+#define SEPARATE_FLAGS(FLAGS, ARRAY) [&](){ std::string flagList(FLAGS); for (size_t begin = 0, end = 0; begin < flagList.size(); begin = end + 1) { end = flagList.find(',', begin); if (std::string::npos == end) end = flagList.size(); std::string flag = flagList.substr(begin, end - begin); TRIM_SPACES(flag); ARRAY.push_back(flag); } if (ARRAY.empty()) return; std::string& lastFlag = ARRAY.back(); size_t pos = lastFlag.find_last_of(" \t"); if (std::string::npos != pos) { lastFlag.erase(pos); TRIM_SPACES(lastFlag); } }()
+#define PRINT_HELP(FLAGS, DEFAULT, MSG) [&](){ if (ap::HelpFormat::Written != ap::s_help_format) AP_WRITE(ap::helpFlag(FLAGS, ap::formatValue(DEFAULT), MSG)); }()
+#define REPLACE_PATTERN(MSG, PTRN, VALUE) [&](){ std::string str(MSG); std::string ptrn(PTRN); if (ptrn.empty()) return str; std::string value(VALUE); std::string replaced; size_t last = 0; for (size_t pos = str.find(ptrn); pos != std::string::npos; pos = str.find(ptrn, last)) { replaced.append(str, last, pos - last).append(value); last = pos + ptrn.size(); } return replaced.append(str, last, std::string::npos); }()
 #define PTRNS(STR, DEF) REPLACE_PATTERN(REPLACE_PATTERN(STR, "%p", ap::s_argv[0]), "%d", DEF)
+#define FIND_VALUE(FLAGS, DEFAULT, MSG) ap::defineFlag(FLAGS, MSG, std::is_same<typename std::decay<decltype(DEFAULT)>::type, bool>::value)
+#define PRINT_FLAG_HELP(INDEX, FLAGS, DEFAULT, MSG) [&](){ PROFILE_SCOPE(Help); PROFILE_INDEX(INDEX); PRINT_HELP(FLAGS, DEFAULT, MSG); }()
+#define AP_MEMBER(STRUCT, MEMBER) STRUCT, decltype(STRUCT::MEMBER), &STRUCT::MEMBER
 #define TRIM_SPACES(STR) [&](){ size_t startpos = STR.find_first_not_of(" \t"); if (std::string::npos != startpos) STR.erase(0, startpos); size_t endpos = STR.find_last_not_of(" \t") + 1; if (std::string::npos != endpos) STR.erase(endpos); }()
 
+inline uint64_t hashToken(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+    return hash;
+}
+
+inline uint64_t hashToken(const std::string& token) { return hashToken(token.data(), token.size()); }
+
+inline bool testBit(const std::vector<uint64_t>& bits, size_t i) { return (bits[i >> 6] >> (i & 63)) & 1; }
+inline void setBit(std::vector<uint64_t>& bits, size_t i) { bits[i >> 6] |= uint64_t(1) << (i & 63); }
+
+inline size_t countBits(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(bits);
+#else
+    size_t count = 0;
+    for (; bits; bits &= bits - 1)
+        ++count;
+    return count;
+#endif
+}
+
+inline size_t lowestBit(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    size_t i = 0;
+    for (; !(bits & 1); bits >>= 1)
+        ++i;
+    return i;
+#endif
+}
+
+/* Returns the bits of the bytes equal to 'byte' in the 'size' <= 64 bytes
+ * of 'data', they are compared 16 at once with SSE2. */
+inline uint64_t matchBytes(const char* data, size_t size, char byte)
+{
+    uint64_t bits = 0;
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i pattern = _mm_set1_epi8(byte);
+    for (; i + 16 <= size; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        bits |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, pattern)))) << i;
+    }
+#endif // defined(__SSE2__)
+    for (; i < size; ++i)
+        bits |= uint64_t(byte == data[i]) << i;
+    return bits;
+}
+
+/* Calls 'f(first, last)' for every part of the 'size' bytes of 'data'
+ * between the delimiters, which are found 64 bytes at once. */
+template <typename F>
+void splitParts(const char* data, size_t size, char delimiter, F f)
+{
+    size_t begin = 0;
+    for (size_t block = 0; block < size; block += 64) {
+        for (uint64_t bits = matchBytes(data + block, size - block < 64 ? size - block : 64, delimiter); bits; bits &= bits - 1) {
+            const size_t end = block + lowestBit(bits);
+            f(data + begin, data + end);
+            begin = end + 1;
+        }
+    }
+    f(data + begin, data + size);
+}
+
+/* Returns the number of parts of the 'size' bytes of 'data' between the
+ * delimiters. */
+inline size_t countParts(const char* data, size_t size, char delimiter)
+{
+    size_t count = 1;
+    for (size_t block = 0; block < size; block += 64)
+        count += countBits(matchBytes(data + block, size - block < 64 ? size - block : 64, delimiter));
+    return count;
+}
+
+inline void parseToken(size_t i)
+{
+    setBit(s_argv_parsed, i);
+    ++s_parsed_count;
+}
+
+/* Returns the first unparsed token or zero. */
+inline size_t firstToken()
+{
+    while (s_first_token < s_argv.size() && testBit(s_argv_parsed, s_first_token))
+        ++s_first_token;
+    return s_first_token < s_argv.size() ? s_first_token : 0;
+}
+
+/* Returns the next unparsed token after the i-th or zero. */
+inline size_t nextToken(size_t i)
+{
+    while (++i < s_argv.size())
+        if (!testBit(s_argv_parsed, i))
+            return i;
+    return 0;
+}
+
+/* The 'key=value' entries of a map flag: the key and the value are views
+ * into the tokens, which are valid until the next PARSE_HELP. The value is
+ * terminated, the key is not. The keys are looked up in an open addressing
+ * table of their hashes, the entries keep the order of argv. */
+class FlagMap {
+public:
+    struct Entry {
+        const char* key;
+        size_t keySize;
+        const char* value;
+    };
+
+    size_t size() const { return _entries.size(); }
+    bool empty() const { return _entries.empty(); }
+    const Entry* begin() const { return _entries.data(); }
+    const Entry* end() const { return _entries.data() + _entries.size(); }
+
+    /* Returns the value of the key or 'def'. */
+    const char* find(const std::string& key, const char* def = nullptr) const
+    {
+        const size_t entry = findEntry(key.data(), key.size(), hashToken(key));
+        return entry ? _entries[entry - 1].value : def;
+    }
+    bool contains(const std::string& key) const { return find(key); }
+
+    void reserve(size_t count)
+    {
+        _entries.reserve(count);
+        _hashes.reserve(count);
+        if (_slots.size() < 2 * count)
+            rehash(2 * count);
+    }
+
+    /* Inserts the entry, or returns false if its key is already inserted,
+     * whose value is replaced by the 'replace' one. */
+    bool insert(const Entry& entry, bool replace)
+    {
+        const uint64_t hash = hashToken(entry.key, entry.keySize);
+        if (const size_t found = findEntry(entry.key, entry.keySize, hash)) {
+            if (replace)
+                _entries[found - 1].value = entry.value;
+            return false;
+        }
+        if (_slots.size() < 2 * (_entries.size() + 1))
+            rehash(2 * (_entries.size() + 1));
+        _entries.push_back(entry);
+        _hashes.push_back(hash);
+        _slots[freeSlot(hash)] = _entries.size();
+        return true;
+    }
+
+private:
+    /* Returns the entry of the key plus one, or zero. */
+    size_t findEntry(const char* key, size_t keySize, uint64_t hash) const
+    {
+        const size_t mask = _slots.size() - 1;
+        for (size_t slot = hash & mask; !_slots.empty() && _slots[slot]; slot = (slot + 1) & mask) {
+            const size_t entry = _slots[slot] - 1;
+            if (_hashes[entry] == hash && _entries[entry].keySize == keySize && !std::memcmp(_entries[entry].key, key, keySize))
+                return entry + 1;
+        }
+        return 0;
+    }
+
+    size_t freeSlot(uint64_t hash) const
+    {
+        const size_t mask = _slots.size() - 1;
+        size_t slot = hash & mask;
+        while (_slots[slot])
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void rehash(size_t count)
+    {
+        size_t size = 1;
+        while (size < count)
+            size <<= 1;
+        _slots.assign(size, 0);
+        for (size_t entry = 0; entry < _entries.size(); ++entry)
+            _slots[freeSlot(_hashes[entry])] = entry + 1;
+    }
+
+    std::vector<Entry> _entries;
+    std::vector<uint64_t> _hashes;
+    /* entry plus one, zero is empty */
+    std::vector<size_t> _slots;
+};
+
+AP_ENGINE void pushToken(std::string&& token, bool joined = false);
+AP_ENGINE size_t matchToken(size_t first, size_t last, size_t from = 0);
+AP_ENGINE size_t findFlag(const std::string& name);
+AP_ENGINE size_t addFlag(const std::string& spec, const std::string& msg, bool isBool, bool again = false);
+AP_ENGINE void setFlag(size_t index, size_t token);
+AP_ENGINE size_t defineFlag(const std::string& spec, const std::string& msg, bool isBool, bool again = true);
+AP_ENGINE size_t defineList(const std::string& spec, const std::string& msg, bool isBool, bool isMap = false);
+AP_ENGINE std::pair<size_t, size_t> listRange(size_t index);
+AP_ENGINE FlagMap readMap(size_t index);
+AP_ENGINE void matchFlags(size_t first);
+AP_ENGINE void addRule(Constraints::Rule::Kind kind, std::initializer_list<std::string> names);
+AP_ENGINE size_t resolveName(size_t name);
+AP_ENGINE void addRow(BitMatrix& matrix, size_t flag, size_t first, size_t last);
+AP_ENGINE void requireFlag(const std::string& name);
+AP_ENGINE void excludeFlags(std::initializer_list<std::string> names);
+AP_ENGINE void dependFlag(const std::string& name, std::initializer_list<std::string> names);
+AP_ENGINE void compileConstraints();
+AP_ENGINE bool checkConstraints();
+AP_ENGINE std::string flagName(size_t flag);
+AP_ENGINE std::string errorMessage(const Error& error);
+AP_ENGINE void clearFlags();
+AP_ENGINE void reset();
+AP_ENGINE bool startSpecMode(int argc, const char* const* argv, const Completion* first, const Completion* last);
+AP_ENGINE std::string helpUsage(const std::string& usage, const char* text);
+AP_ENGINE std::string helpFlag(const std::string& flags, const std::string& def, const std::string& msg);
+AP_ENGINE std::string helpMessage(const std::string& msg);
+AP_ENGINE std::string helpBlob(const std::string& text);
+AP_ENGINE std::string escapeRoff(const std::string& text);
+AP_ENGINE std::string completions(const std::string& flags, const std::string& def, const std::string& msg);
+AP_ENGINE void completeAlias(const Completion& alias, std::string& candidates);
+AP_ENGINE std::string completeTable(const Completion* first, const Completion* last);
+AP_ENGINE std::string completionScript();
+AP_ENGINE std::string escapeQuotes(const std::string& str);
+#if defined(AP_PROFILE)
+AP_ENGINE const char* phaseName(ProfileRecord::Phase phase);
+AP_ENGINE std::string recordName(const ProfileRecord& record);
+AP_ENGINE std::string profileReport(size_t count);
+#endif // defined(AP_PROFILE)
+
+template <typename T>
+struct ValueCache {
+    struct Entry {
+        size_t generation;
+        T value;
+    };
+    static std::vector<Entry> s_entries;
+};
+
+template <typename T>
+std::vector<typename ValueCache<T>::Entry> ValueCache<T>::s_entries;
+
+/* The conversions follow the stream extraction without iostreams: leading
+ * spaces are skipped, a number ends at its first invalid character, and an
+ * overflow fails. Other types need the stream ones of AP_STREAM. */
+inline bool convertValue(const std::string& token, std::string& result) { result = token; return true; }
+inline bool convertValue(const std::string&, bool& result) { result = !result; return true; }
+/* A view of the token, it is valid until the next PARSE_HELP. */
+inline bool convertValue(const std::string& token, const char*& result) { result = token.c_str(); return true; }
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, bool>::type
+convertValue(const std::string& token, T& result)
+{
+    const char* begin = token.c_str();
+    char* end = nullptr;
+    errno = 0;
+    const long long value = std::strtoll(begin, &end, 10);
+    if (end == begin || ERANGE == errno || value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max())
+        return false;
+    result = static_cast<T>(value);
+    return true;
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value, bool>::type
+convertValue(const std::string& token, T& result)
+{
+    const char* begin = token.c_str();
+    while (std::isspace(static_cast<unsigned char>(*begin)))
+        ++begin;
+    /* A negative value wraps around like unsigned arithmetic. */
+    const bool negative = '-' == *begin;
+    if (negative || '+' == *begin)
+        ++begin;
+    if (!std::isdigit(static_cast<unsigned char>(*begin)))
+        return false;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long value = std::strtoull(begin, &end, 10);
+    if (ERANGE == errno || value > std::numeric_limits<T>::max())
+        return false;
+    result = static_cast<T>(negative ? 0 - value : value);
+    return true;
+}
+
+inline bool convertValue(const std::string& token, char& result)
+{
+    const size_t i = token.find_first_not_of(" \t\n\v\f\r");
+    if (std::string::npos == i)
+        return false;
+    result = token[i];
+    return true;
+}
+
+inline bool convertValue(const std::string& token, signed char& result) { char c; return convertValue(token, c) && (result = static_cast<signed char>(c), true); }
+inline bool convertValue(const std::string& token, unsigned char& result) { char c; return convertValue(token, c) && (result = static_cast<unsigned char>(c), true); }
+
+inline float parseFloat(const char* str, char** end, float) { return std::strtof(str, end); }
+inline double parseFloat(const char* str, char** end, double) { return std::strtod(str, end); }
+inline long double parseFloat(const char* str, char** end, long double) { return std::strtold(str, end); }
+
+/* Only the characters of a decimal number are taken and all of them have to
+ * be converted, so '1e' fails and '0x10' is 0, like with the streams. */
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+convertValue(const std::string& token, T& result)
+{
+    const size_t begin = token.find_first_not_of(" \t\n\v\f\r");
+    if (std::string::npos == begin)
+        return false;
+    size_t i = begin;
+    if ('+' == token[i] || '-' == token[i])
+        ++i;
+    bool mantissa = false;
+    bool point = false;
+    for (; i < token.size(); ++i) {
+        if (std::isdigit(static_cast<unsigned char>(token[i])))
+            mantissa = true;
+        else if ('.' == token[i] && !point)
+            point = true;
+        else
+            break;
+    }
+    if (mantissa && i < token.size() && ('e' == token[i] || 'E' == token[i])) {
+        if (++i < token.size() && ('+' == token[i] || '-' == token[i]))
+            ++i;
+        while (i < token.size() && std::isdigit(static_cast<unsigned char>(token[i])))
+            ++i;
+    }
+
+    const std::string number = token.substr(begin, i - begin);
+    char* end = nullptr;
+    const T value = parseFloat(number.c_str(), &end, T());
+    if (end == number.c_str() || *end || value == std::numeric_limits<T>::infinity() || value == -std::numeric_limits<T>::infinity())
+        return false;
+    result = value;
+    return true;
+}
+
+#if defined(AP_STREAM)
+template <typename T>
+typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type
+convertValue(const std::string& token, T& result)
+{
+    std::istringstream iss(token);
+    T value(result);
+    if (!(iss >> value))
+        return false;
+    result = std::move(value);
+    return true;
+}
+#endif // defined(AP_STREAM)
+
+/* Converts the integer of [first, last) like 'convertValue()' does, but
+ * without a terminated copy: at most 19 digits are summed without overflow
+ * checks, which are done once at the end. On little endian targets the first
+ * 8 digits are converted at once when the bytes up to 'limit' can be read. */
+template <typename T>
+bool parseInteger(const char* first, const char* last, T& result, const char* limit = nullptr)
+{
+    while (first < last && (' ' == *first || static_cast<unsigned char>(*first - '\t') < 5))
+        ++first;
+    const bool negative = first < last && '-' == *first;
+    if (first < last && (negative || '+' == *first))
+        ++first;
+    if (first == last || static_cast<unsigned char>(*first - '0') > 9)
+        return false;
+    while (first + 1 < last && '0' == *first && static_cast<unsigned char>(first[1] - '0') <= 9)
+        ++first;
+
+    unsigned long long value = 0;
+    size_t digits = 0;
+#if defined(__BYTE_ORDER__) && __ORDER_LITTLE_ENDIAN__ == __BYTE_ORDER__
+    if (limit && limit - first >= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, first, 8);
+        uint64_t nonDigits = ((chunk + 0x4646464646464646ull) | (chunk - 0x3030303030303030ull)) & 0x8080808080808080ull;
+        if (last - first < 8)
+            nonDigits |= 0x80ull << (8 * (last - first));
+        digits = nonDigits ? lowestBit(nonDigits) >> 3 : 8;
+        /* The digits are moved to the top, the pairs, quads and the halves
+         * are summed by one multiplication each. */
+        chunk = (chunk - 0x3030303030303030ull) << (64 - 8 * digits);
+        chunk = ((chunk & 0x0f0f0f0f0f0f0f0full) * 2561) >> 8;
+        chunk = ((chunk & 0x00ff00ff00ff00ffull) * 6553601) >> 16;
+        value = ((chunk & 0x0000ffff0000ffffull) * 42949672960001ull) >> 32;
+        first += digits;
+    }
+#endif // defined(__BYTE_ORDER__) && __ORDER_LITTLE_ENDIAN__ == __BYTE_ORDER__
+    for (; first < last && static_cast<unsigned char>(*first - '0') <= 9 && digits < 19; ++first, ++digits)
+        value = value * 10 + static_cast<unsigned>(*first - '0');
+    if (first < last && static_cast<unsigned char>(*first - '0') <= 9) {
+        const unsigned digit = static_cast<unsigned>(*first - '0');
+        if (value > (std::numeric_limits<unsigned long long>::max() - digit) / 10)
+            return false;
+        value = value * 10 + digit;
+        if (++first < last && static_cast<unsigned char>(*first - '0') <= 9)
+            return false;
+    }
+
+    if (std::is_unsigned<T>::value) {
+        /* A negative value wraps around like unsigned arithmetic. */
+        if (value > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+            return false;
+        result = static_cast<T>(negative ? 0 - value : value);
+        return true;
+    }
+    const unsigned long long maximum = static_cast<unsigned long long>(std::numeric_limits<T>::max()) + negative;
+    if (value > maximum)
+        return false;
+    result = negative && value ? static_cast<T>(-static_cast<long long>(value - 1) - 1) : static_cast<T>(value);
+    return true;
+}
+
+/* Converts a part of a token, which can be read up to 'limit', the integers
+ * directly, the other types from a copy of it. */
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && (sizeof(T) > 1), bool>::type
+convertRange(const char* first, const char* last, const char* limit, T& result) { return parseInteger(first, last, result, limit); }
+
+template <typename T>
+typename std::enable_if<!std::is_integral<T>::value || sizeof(T) == 1, bool>::type
+convertRange(const char* first, const char* last, const char*, T& result) { return convertValue(std::string(first, last), result); }
+
+/* Converts the parts of the 'size' bytes of 'data' between the delimiters
+ * into 'out', which has room for all of them, and returns the number of the
+ * converted ones. The bytes can be read up to 'limit'. The empty parts, also
+ * a lone '\r', are skipped with 'skipEmpty', the other wrong ones are counted
+ * in 'wrong'. */
+template <typename T, typename Out>
+size_t convertParts(const char* data, size_t size, const char* limit, char delimiter, bool skipEmpty, Out out, size_t& wrong)
+{
+    size_t count = 0;
+    splitParts(data, size, delimiter, [&](const char* first, const char* last) {
+        if (skipEmpty && (first == last || (first + 1 == last && '\r' == *first)))
+            return;
+        T value = T();
+        if (convertRange(first, last, limit, value)) {
+            *out = std::move(value);
+            ++out;
+            ++count;
+        } else {
+            ++wrong;
+        }
+    });
+    return count;
+}
+
+/* Formats the default value of the help like the stream insertion does. */
+inline std::string formatValue(const std::string& value) { return value; }
+inline std::string formatValue(const char* value) { return value; }
+inline std::string formatValue(bool value) { return value ? "1" : "0"; }
+inline std::string formatValue(char value) { return std::string(1, value); }
+inline std::string formatValue(signed char value) { return std::string(1, static_cast<char>(value)); }
+inline std::string formatValue(unsigned char value) { return std::string(1, static_cast<char>(value)); }
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value, std::string>::type
+formatValue(const T& value) { return std::to_string(value); }
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, std::string>::type
+formatValue(const T& value)
+{
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%Lg", static_cast<long double>(value));
+    return buffer;
+}
+
+#if defined(AP_STREAM)
+template <typename T>
+typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_convertible<T, std::string>::value, std::string>::type
+formatValue(const T& value) { std::ostringstream oss; oss << value; return oss.str(); }
+#endif // defined(AP_STREAM)
+
+template <typename T>
+std::string formatValue(const std::vector<T>& values)
+{
+    std::string str;
+    for (size_t i = 0; i < values.size(); ++i)
+        str += (i ? "," : "") + formatValue(static_cast<const T&>(values[i]));
+    return str;
+}
+
+/* Reads a positional argument like the stream extraction: a string is its
+ * first word, and a failed conversion gives the value-initialized type. */
+template <typename T>
+void readArg(size_t i, T& arg)
+{
+    if (!convertValue(s_argv[i], arg))
+        arg = T();
+}
+
+inline void readArg(size_t i, bool& arg)
+{
+    long value = 0;
+    arg = convertValue(s_argv[i], value) && value;
+}
+
+inline void readArg(size_t i, std::string& arg)
+{
+    const std::string& token = s_argv[i];
+    const size_t begin = token.find_first_not_of(" \t\n\v\f\r");
+    arg = std::string::npos == begin ? std::string() : token.substr(begin, token.find_first_of(" \t\n\v\f\r", begin) - begin);
+}
+
+inline void writeOut(const std::string& str) { std::fwrite(str.data(), 1, str.size(), stdout); }
+
+/* Converts the raw token of the value on the first read of type T only, every
+ * later read returns the cached result. A failed conversion is recorded once
+ * in 's_errors' and the default value is kept. */
+template <typename T>
+const T& readValue(size_t index, const T& def)
+{
+    std::vector<typename ValueCache<T>::Entry>& entries = ValueCache<T>::s_entries;
+    if (entries.size() <= index)
+        entries.resize(index + 1, { 0, def });
+    typename ValueCache<T>::Entry& entry = entries[index];
+    if (entry.generation != s_generation) {
+        PROFILE_SCOPE(Convert);
+        PROFILE_INDEX(index);
+        entry.generation = s_generation;
+        entry.value = def;
+        if (testBit(s_flags.isSet, index) && !convertValue(s_argv[s_flags.valueTokens[index]], entry.value)) {
+            entry.value = def;
+            s_errors.push(Error::WrongValue, s_flags.valueTokens[index], index);
+        }
+    }
+    return entry.value;
+}
+
+/* Converts the value tokens of a list flag in order, or returns the default
+ * when it is not set. A wrong value is recorded in 's_errors' and skipped. */
+template <typename T>
+std::vector<T> readList(size_t index, const std::vector<T>& def)
+{
+    const std::pair<size_t, size_t> range = listRange(index);
+    if (range.first == range.second)
+        return def;
+
+    PROFILE_SCOPE(Convert);
+    PROFILE_INDEX(index);
+    std::vector<T> values;
+    values.reserve(range.second - range.first);
+    for (size_t i = range.first; i < range.second; ++i) {
+        const size_t token = s_flags.listTokens[i];
+        T value = T();
+        if (convertValue(s_argv[token], value))
+            values.push_back(value);
+        else
+            s_errors.push(Error::WrongValue, token, index);
+    }
+    return values;
+}
+
+/* Converts the delimited values of the value tokens of a list flag in order
+ * into a vector, which is allocated once, or returns the default when it is
+ * not set. A wrong value is recorded in 's_errors' and skipped. */
+template <typename T>
+std::vector<T> readSplit(size_t index, const std::vector<T>& def)
+{
+    static_assert(!std::is_pointer<T>::value, "The split values are not terminated, read them as std::string.");
+    const std::pair<size_t, size_t> range = listRange(index);
+    if (range.first == range.second)
+        return def;
+
+    PROFILE_SCOPE(Convert);
+    PROFILE_INDEX(index);
+    const char delimiter = s_list_delimiter;
+    size_t count = 0;
+    for (size_t i = range.first; i < range.second; ++i)
+        count += countParts(s_argv[s_flags.listTokens[i]].data(), s_argv[s_flags.listTokens[i]].size(), delimiter);
+    std::vector<T> values(count);
+    size_t size = 0;
+    for (size_t i = range.first; i < range.second; ++i) {
+        const size_t token = s_flags.listTokens[i];
+        const std::string& value = s_argv[token];
+        size_t wrong = 0;
+        size += convertParts<T>(value.data(), value.size(), value.data() + value.size(), delimiter, false, values.begin() + size, wrong);
+        for (; wrong; --wrong)
+            s_errors.push(Error::WrongValue, token, index);
+    }
+    values.resize(size);
+    return values;
+}
+
+/* Lightweight handle of a defined flag: the value is converted on the first
+ * 'read()' only, later ones return the cached value. It is valid until the
+ * next PARSE_HELP, after it the handle reads its own default and it is not
+ * set. The handle of an unknown flag keeps its own default, the wrong flag is
+ * never set. */
+template <typename T>
+struct Flag {
+    size_t index;
+    T def;
+    size_t generation;
+
+    bool isSet() const { return generation == s_generation && testBit(s_flags.isSet, index); }
+    const T& read() const { return s_wrong_flag == index || generation != s_generation ? def : readValue(index, def); }
+};
+
+template <typename T>
+Flag<T> flagHandle(size_t index, const T& def)
+{
+    return { index, def, s_generation };
+}
+
+/* The 'new' of C++11 does not respect an alignment over the one of
+ * 'max_align_t', the over-aligned objects are allocated by these. */
+inline void* allocateAligned(size_t size, size_t alignment)
+{
+#if defined(_WIN32)
+    if (void* ptr = _aligned_malloc(size ? size : 1, alignment))
+        return ptr;
+#else
+    void* ptr = nullptr;
+    if (!posix_memalign(&ptr, alignment, size ? size : 1))
+        return ptr;
+#endif // defined(_WIN32)
+    throw std::bad_alloc();
+}
+
+inline void freeAligned(void* ptr)
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif // defined(_WIN32)
+}
+
+/* An immutable copy of the values of flag handles, they are read by their
+ * compile-time index. It does not refer to the parser state, so any number of
+ * threads can read it while the parser is reused. It starts on its own cache
+ * line, which it does not share with written data, also when it is allocated
+ * by 'new'. */
+template <typename... T>
+class alignas(64) Snapshot {
+public:
+    typedef std::tuple<T...> Values;
+
+    explicit Snapshot(const Flag<T>&... flags)
+        : _values(flags.read()...)
+        , _isSet(setBits({ flags.isSet()... }))
+    {
+    }
+
+    static void* operator new(size_t size) { return allocateAligned(size, alignof(Snapshot)); }
+    static void* operator new[](size_t size) { return allocateAligned(size, alignof(Snapshot)); }
+    static void operator delete(void* ptr) { freeAligned(ptr); }
+    static void operator delete[](void* ptr) { freeAligned(ptr); }
+
+    template <size_t I>
+    const typename std::tuple_element<I, Values>::type& get() const { return std::get<I>(_values); }
+
+    template <size_t I>
+    bool isSet() const
+    {
+        static_assert(I < sizeof...(T), "Snapshot index out of range.");
+        return (_isSet[I >> 6] >> (I & 63)) & 1;
+    }
+
+private:
+    typedef std::array<uint64_t, (sizeof...(T) + 63) / 64> Bits;
+
+    static Bits setBits(std::initializer_list<bool> flags)
+    {
+        Bits bits = {};
+        size_t i = 0;
+        for (bool isSet : flags) {
+            bits[i >> 6] |= uint64_t(isSet) << (i & 63);
+            ++i;
+        }
+        return bits;
+    }
+
+    const Values _values;
+    const Bits _isSet;
+};
+
+template <typename... T>
+Snapshot<T...> freezeFlags(const Flag<T>&... flags) { return Snapshot<T...>(flags...); }
+
+/* A struct member bound to a flag, or to an argument without 'spec'. The
+ * functions are instantiated for the member, so the values are converted
+ * straight into it. */
+template <typename S>
+struct Field {
+    const char* spec;
+    const char* msg;
+    bool isBool;
+    bool (*read)(const std::string& value, S& object);
+    void (*readArg)(size_t token, S& object);
+    std::string (*format)(const S& object);
+    void (*copy)(const S& from, S& to);
+};
+
+template <typename S, typename T, T S::*M>
+bool readField(const std::string& value, S& object) { return convertValue(value, object.*M); }
+
+template <typename S, typename T, T S::*M>
+void copyField(const S& from, S& to) { to.*M = from.*M; }
+
+template <typename S, typename T, T S::*M>
+std::string formatField(const S& object) { return formatValue(object.*M); }
+
+template <typename T>
+void readArgs(size_t token, T& arg)
+{
+    readArg(token, arg);
+    parseToken(token);
+}
+
+template <typename T>
+void readArgs(size_t token, std::vector<T>& args)
+{
+    args.clear();
+    for (; token; token = nextToken(token)) {
+        args.push_back(T());
+        readArg(token, args.back());
+        parseToken(token);
+    }
+}
+
+template <typename S, typename T, T S::*M>
+void readArgField(size_t token, S& object) { readArgs(token, object.*M); }
+
+/* Defines the flags of the fields and parses them in one pass over the
+ * tokens, where a value flag takes the token after it. A set flag is
+ * converted into its member, a wrong value is recorded in 's_errors' and the
+ * member is kept. Then the arguments take the unparsed tokens in the order of
+ * the fields. */
+template <typename Fields, typename S>
+void parseFields(const Fields& fields, S& object)
+{
+    std::vector<size_t> indices;
+    const size_t first = s_flags.aliasHashes.size();
+    for (const Field<S>& field : fields)
+        indices.push_back(field.spec ? addFlag(field.spec, field.msg, field.isBool) : s_wrong_flag);
+    if (s_help)
+        return;
+
+    matchFlags(first);
+    const size_t* index = indices.data();
+    for (const Field<S>& field : fields) {
+        const size_t flag = *index++;
+        if (!testBit(s_flags.isSet, flag))
+            continue;
+        PROFILE_SCOPE(Convert);
+        PROFILE_INDEX(flag);
+        if (!field.read(s_argv[s_flags.valueTokens[flag]], object))
+            s_errors.push(Error::WrongValue, s_flags.valueTokens[flag], flag);
+    }
+
+    for (const Field<S>& field : fields)
+        if (!field.spec)
+            if (const size_t token = firstToken())
+                field.readArg(token, object);
+}
+
+/* Instantiations of the common value types. With AP_LIBRARY they are compiled
+ * by the library and the includers only declare them. */
+#define AP_INSTANTIATE_VALUE(EXTERN, T) \
+    EXTERN template struct ValueCache<T>;\
+    EXTERN template const T& readValue<T>(size_t, const T&);\
+    EXTERN template Flag<T> flagHandle<T>(size_t, const T&);
+#define AP_INSTANTIATE_NUMBER(EXTERN, T) AP_INSTANTIATE_VALUE(EXTERN, T)\
+    EXTERN template void readArg<T>(size_t, T&);\
+    EXTERN template std::string formatValue<T>(const T&);
+#define AP_INSTANTIATE(EXTERN) \
+    AP_INSTANTIATE_VALUE(EXTERN, bool) AP_INSTANTIATE_VALUE(EXTERN, std::string)\
+    AP_INSTANTIATE_NUMBER(EXTERN, int) AP_INSTANTIATE_NUMBER(EXTERN, unsigned)\
+    AP_INSTANTIATE_NUMBER(EXTERN, long) AP_INSTANTIATE_NUMBER(EXTERN, unsigned long)\
+    AP_INSTANTIATE_NUMBER(EXTERN, long long) AP_INSTANTIATE_NUMBER(EXTERN, unsigned long long)\
+    AP_INSTANTIATE_NUMBER(EXTERN, float) AP_INSTANTIATE_NUMBER(EXTERN, double)
+
+#if defined(AP_LIBRARY) && !defined(AP_IMPLEMENTATION)
+AP_INSTANTIATE(extern)
+#endif // defined(AP_LIBRARY) && !defined(AP_IMPLEMENTATION)
+
+/* The engine is defined by the header, or by the library with AP_LIBRARY. */
+#if !defined(AP_LIBRARY) || defined(AP_IMPLEMENTATION)
+
+AP_ENGINE void AP_CHECK_CONFIG() {}
+
+/* A joined token was split from the previous one at a long flag delimiter. */
+AP_ENGINE void pushToken(std::string&& token, bool joined)
+{
+    if (s_argv_parsed.size() * 64 <= s_argv.size()) {
+        s_argv_parsed.push_back(0);
+        s_argv_joined.push_back(0);
+    }
+    if (joined)
+        setBit(s_argv_joined, s_argv.size());
+    s_argv_hashes.push_back(hashToken(token));
+    s_argv.push_back(std::move(token));
+}
+
+/* Returns the first unparsed token from the 'from'-th on, or from the first
+ * unparsed one, which matches any alias in [first, last). */
+AP_ENGINE size_t matchToken(size_t first, size_t last, size_t from)
+{
+    const uint64_t* aliasHashes = s_flags.aliasHashes.data();
+    const uint64_t* tokenHashes = s_argv_hashes.data();
+    for (size_t i = from ? from : firstToken(); i && i < s_argv.size(); ++i) {
+        if (testBit(s_argv_parsed, i))
+            continue;
+        for (size_t a = first; a < last; ++a)
+            if (tokenHashes[i] == aliasHashes[a] && s_argv[i] == s_flags.aliases[a])
+                return i;
+    }
+    return 0;
+}
+
+/* Returns the last defined flag which has the alias or the wrong flag. */
+AP_ENGINE size_t findFlag(const std::string& name)
+{
+    return s_flags.findAlias(name, hashToken(name));
+}
+
+/* Adds the flag once per spec with its aliases, or 'again' as a new flag
+ * which replaces the previous one of the spec. Its tokens are not parsed. */
+AP_ENGINE size_t addFlag(const std::string& spec, const std::string& msg, bool isBool, bool again)
+{
+    const uint64_t specHash = hashToken(spec);
+    const size_t found = s_flags.findSpec(spec, specHash);
+    if (found && !again)
+        return found;
+
+    const size_t index = s_flags.size();
+    s_flags.specs.push_back(spec);
+    s_flags.specHashes.push_back(specHash);
+    s_flags.messages.push_back(msg);
+    s_flags.flagTokens.push_back(0);
+    s_flags.valueTokens.push_back(0);
+    s_flags.indexSpec();
+    if (s_flags.isSet.size() * 64 <= index) {
+        s_flags.isSet.push_back(0);
+        s_flags.isBool.push_back(0);
+    }
+    if (isBool)
+        setBit(s_flags.isBool, index);
+
+    /* Split like SEPARATE_FLAGS, but in place. */
+    const char* spaces = " \t";
+    for (size_t begin = 0, end = 0; begin < spec.size(); begin = end + 1) {
+        end = spec.find(',', begin);
+        if (std::string::npos == end)
+            end = spec.size();
+        size_t first = spec.find_first_not_of(spaces, begin);
+        size_t last = end;
+        if (first >= end) {
+            first = end;
+        } else {
+            last = spec.find_last_not_of(spaces, end - 1) + 1;
+            /* The last alias ends before its value name. */
+            const size_t space = end + 1 >= spec.size() ? spec.find_last_of(spaces, last - 1) : std::string::npos;
+            if (std::string::npos != space && space > first)
+                last = spec.find_last_not_of(spaces, space) + 1;
+        }
+        s_flags.aliases.emplace_back(spec, first, last - first);
+        s_flags.aliasHashes.push_back(hashToken(s_flags.aliases.back()));
+        s_flags.aliasFlags.push_back(index);
+        s_flags.indexAlias();
+    }
+    return index;
+}
+
+/* Sets the flag found at the j-th token. A bool flag takes no value token,
+ * any other flag takes the next unparsed token. A repeated flag keeps its
+ * first tokens unless the last one wins. */
+AP_ENGINE void setFlag(size_t index, size_t j)
+{
+    const size_t value = !j || testBit(s_flags.isBool, index) ? j : nextToken(j);
+    if (!value)
+        return;
+    parseToken(j);
+    if (value != j)
+        parseToken(value);
+    if (testBit(s_flags.isSet, index) && Repeat::Last != s_repeat)
+        return;
+    setBit(s_flags.isSet, index);
+    s_flags.flagTokens[index] = j;
+    s_flags.valueTokens[index] = value;
+}
+
+/* Defines the flag and parses its first unparsed token, or all of them in
+ * one pass when the repeated ones are parsed too. Defined 'again' with the
+ * same spec it is a new flag, which parses the next occurrence and has its
+ * own cached value, like every definition took its own token before. */
+AP_ENGINE size_t defineFlag(const std::string& spec, const std::string& msg, bool isBool, bool again)
+{
+    PROFILE_SCOPE(Lookup);
+    const size_t first = s_flags.aliasHashes.size();
+    const size_t index = addFlag(spec, msg, isBool, again && !s_help && Repeat::Once == s_repeat);
+    PROFILE_INDEX(index);
+    const size_t last = s_flags.aliasHashes.size();
+    if (s_help || first == last)
+        return index;
+    for (size_t j = matchToken(first, last); j; j = Repeat::Once == s_repeat ? 0 : matchToken(first, last, j + 1))
+        setFlag(index, j);
+    return index;
+}
+
+/* Defines the list flag once per spec and parses all of its tokens in one
+ * pass. Its value tokens are stored in order, the first ones are also the
+ * tokens of the flag. The value of a map flag takes the token joined to it
+ * too, which is its value after the key. */
+AP_ENGINE size_t defineList(const std::string& spec, const std::string& msg, bool isBool, bool isMap)
+{
+    PROFILE_SCOPE(Lookup);
+    const size_t first = s_flags.aliasHashes.size();
+    const size_t index = addFlag(spec, msg, isBool);
+    PROFILE_INDEX(index);
+    const size_t last = s_flags.aliasHashes.size();
+    if (s_help || first == last)
+        return index;
+    for (size_t j = matchToken(first, last); j; j = matchToken(first, last, j + 1)) {
+        const size_t value = isBool ? j : nextToken(j);
+        if (!value)
+            break;
+        parseToken(j);
+        if (value != j)
+            parseToken(value);
+        if (isMap && value + 1 < s_argv.size() && testBit(s_argv_joined, value + 1) && !testBit(s_argv_parsed, value + 1))
+            parseToken(value + 1);
+        if (!testBit(s_flags.isSet, index)) {
+            setBit(s_flags.isSet, index);
+            s_flags.flagTokens[index] = j;
+            s_flags.valueTokens[index] = value;
+        }
+        s_flags.listTokens.push_back(value);
+    }
+    s_flags.lists.push_back({ index, s_flags.listTokens.size() });
+    return index;
+}
+
+/* Returns the range of the value tokens of the list flag in 'listTokens'. */
+AP_ENGINE std::pair<size_t, size_t> listRange(size_t index)
+{
+    size_t end = s_flags.lists.size();
+    while (end && s_flags.lists[end - 1].first != index)
+        --end;
+    const size_t begin = end > 1 ? s_flags.lists[end - 2].second : 0;
+    return { begin, end ? s_flags.lists[end - 1].second : begin };
+}
+
+/* Builds the map of the map flag. A value is split at its first long flag
+ * delimiter, unless the rest is joined to it already. A key without value
+ * has an empty value. */
+AP_ENGINE FlagMap readMap(size_t index)
+{
+    PROFILE_SCOPE(Convert);
+    PROFILE_INDEX(index);
+    const std::pair<size_t, size_t> range = listRange(index);
+    FlagMap map;
+    map.reserve(range.second - range.first);
+    for (size_t i = range.first; i < range.second; ++i) {
+        const size_t token = s_flags.listTokens[i];
+        const std::string& value = s_argv[token];
+        FlagMap::Entry entry = { value.c_str(), value.size(), "" };
+        size_t pos = std::string::npos;
+        if (token + 1 < s_argv.size() && testBit(s_argv_joined, token + 1))
+            entry.value = s_argv[token + 1].c_str();
+        else if (std::string::npos != (pos = value.find_first_of(s_long_flag_delimiter)))
+            entry = { value.c_str(), pos, value.c_str() + pos + 1 };
+        if (!map.insert(entry, Duplicate::Last == s_duplicate_key) && Duplicate::Reject == s_duplicate_key)
+            s_errors.push(Error::DuplicateKey, token, index);
+    }
+    return map;
+}
+
+/* Parses the flags of the aliases from 'first' on in one pass over the
+ * unparsed tokens: a token sets its flag unless that is already set and the
+ * repeated flags are not parsed. The
+ * aliases are looked up in an open addressing table of their hashes. */
+AP_ENGINE void matchFlags(size_t first)
+{
+    PROFILE_SCOPE(Lookup);
+    const size_t last = s_flags.aliasHashes.size();
+    if (first == last)
+        return;
+
+    size_t size = 1;
+    while (size < 2 * (last - first))
+        size <<= 1;
+    std::vector<size_t> slots(size, 0);
+    const size_t mask = size - 1;
+    const uint64_t* aliasHashes = s_flags.aliasHashes.data();
+    for (size_t a = first; a < last; ++a) {
+        size_t slot = aliasHashes[a] & mask;
+        while (slots[slot])
+            slot = (slot + 1) & mask;
+        slots[slot] = a + 1;
+    }
+
+    const uint64_t* tokenHashes = s_argv_hashes.data();
+    for (size_t i = firstToken(); i && i < s_argv.size(); ++i) {
+        if (testBit(s_argv_parsed, i))
+            continue;
+        for (size_t slot = tokenHashes[i] & mask; slots[slot]; slot = (slot + 1) & mask) {
+            const size_t a = slots[slot] - 1;
+            if (aliasHashes[a] == tokenHashes[i] && s_argv[i] == s_flags.aliases[a]) {
+                if (!testBit(s_flags.isSet, s_flags.aliasFlags[a]) || Repeat::Once != s_repeat)
+                    setFlag(s_flags.aliasFlags[a], i);
+                break;
+            }
+        }
+    }
+}
+
+AP_ENGINE void addRule(Constraints::Rule::Kind kind, std::initializer_list<std::string> names)
+{
+    const size_t first = s_constraints.names.size();
+    s_constraints.names.insert(s_constraints.names.end(), names.begin(), names.end());
+    s_constraints.rules.push_back({ kind, first, s_constraints.names.size() });
+}
+
+/* Returns the flag of the name-th constraint name, an unknown one is recorded
+ * in 's_errors' once and it is the wrong flag. */
+AP_ENGINE size_t resolveName(size_t name)
+{
+    const size_t flag = findFlag(s_constraints.names[name]);
+    if (s_wrong_flag == flag) {
+        s_constraints.resolved = false;
+        if (!testBit(s_constraints.reportedNames, name)) {
+            setBit(s_constraints.reportedNames, name);
+            s_errors.push(Error::UnknownFlag, 0, name);
+        }
+    }
+    return flag;
+}
+
+AP_ENGINE void addRow(BitMatrix& matrix, size_t flag, size_t first, size_t last)
+{
+    const size_t begin = matrix.bits.size();
+    matrix.bits.resize(begin + s_flags.isSet.size(), 0);
+    for (size_t name = first; name < last; ++name)
+        if (const size_t index = resolveName(name))
+            matrix.bits[begin + (index >> 6)] |= uint64_t(1) << (index & 63);
+    matrix.rowEnds.push_back(matrix.bits.size());
+    matrix.rowFlags.push_back(flag);
+}
+
+AP_ENGINE void requireFlag(const std::string& name) { addRule(Constraints::Rule::Require, { name }); }
+AP_ENGINE void excludeFlags(std::initializer_list<std::string> names) { addRule(Constraints::Rule::Exclude, names); }
+
+AP_ENGINE void dependFlag(const std::string& name, std::initializer_list<std::string> names)
+{
+    addRule(Constraints::Rule::Depend, { name });
+    s_constraints.names.insert(s_constraints.names.end(), names.begin(), names.end());
+    s_constraints.rules.back().last = s_constraints.names.size();
+}
+
+/* Resolves the names of the constraints into flags by their alias hashes,
+ * so they can be declared before the flags. The names which are not defined
+ * by now are recorded in 's_errors'. */
+AP_ENGINE void compileConstraints()
+{
+    s_constraints.compiledRules = s_constraints.rules.size();
+    s_constraints.compiledFlags = s_flags.size();
+    s_constraints.resolved = true;
+    s_constraints.reportedNames.resize((s_constraints.names.size() + 63) / 64, 0);
+    s_constraints.required.assign(s_flags.isSet.size(), 0);
+    s_constraints.exclusive.clear();
+    s_constraints.dependencies.clear();
+    for (const Constraints::Rule& rule : s_constraints.rules) {
+        switch (rule.kind) {
+        case Constraints::Rule::Require:
+            if (const size_t flag = resolveName(rule.first))
+                setBit(s_constraints.required, flag);
+            break;
+        case Constraints::Rule::Exclude:
+            addRow(s_constraints.exclusive, s_wrong_flag, rule.first, rule.last);
+            break;
+        case Constraints::Rule::Depend:
+            addRow(s_constraints.dependencies, resolveName(rule.first), rule.first + 1, rule.last);
+            break;
+        }
+    }
+}
+
+/* Validates the set flags against the compiled constraints: each check is a
+ * few word wide AND operations over the isSet bitset. Violations are
+ * recorded in 's_errors', the check fails while a name is not defined. */
+AP_ENGINE bool checkConstraints()
+{
+    if (s_help)
+        return true;
+
+    PROFILE_SCOPE(Validate);
+
+    const size_t errors = s_errors.count;
+    if (s_constraints.compiledRules != s_constraints.rules.size() || s_constraints.compiledFlags != s_flags.size())
+        compileConstraints();
+    const uint64_t* isSet = s_flags.isSet.data();
+
+    for (size_t w = 0; w < s_constraints.required.size(); ++w)
+        for (uint64_t missing = s_constraints.required[w] & ~isSet[w]; missing; missing &= missing - 1)
+            s_errors.push(Error::MissingFlag, 0, w * 64 + lowestBit(missing));
+
+    const BitMatrix& exclusive = s_constraints.exclusive;
+    for (size_t row = 0; row < exclusive.rows(); ++row) {
+        size_t count = 0;
+        for (size_t w = exclusive.rowBegin(row); w < exclusive.rowEnds[row]; ++w) {
+            const uint64_t set = exclusive.bits[w] & isSet[w - exclusive.rowBegin(row)];
+            if (count + countBits(set) > 1) {
+                /* Report the second set flag of the group. */
+                const size_t flag = (w - exclusive.rowBegin(row)) * 64 + lowestBit(count ? set : set & (set - 1));
+                s_errors.push(Error::ExclusiveFlag, s_flags.flagTokens[flag], flag);
+                break;
+            }
+            count += countBits(set);
+        }
+    }
+
+    const BitMatrix& dependencies = s_constraints.dependencies;
+    for (size_t row = 0; row < dependencies.rows(); ++row) {
+        const size_t owner = dependencies.rowFlags[row];
+        if (!testBit(s_flags.isSet, owner))
+            continue;
+        for (size_t w = dependencies.rowBegin(row); w < dependencies.rowEnds[row]; ++w)
+            for (uint64_t missing = dependencies.bits[w] & ~isSet[w - dependencies.rowBegin(row)]; missing; missing &= missing - 1)
+                s_errors.push(Error::MissingDependency, s_flags.flagTokens[owner], (w - dependencies.rowBegin(row)) * 64 + lowestBit(missing));
+    }
+
+    PROFILE_INDEX(s_errors.count - errors);
+    return errors == s_errors.count && s_constraints.resolved;
+}
+
+/* Returns the first alias of the flag, or its index if it is not defined. */
+AP_ENGINE std::string flagName(size_t flag)
+{
+    for (size_t a = 0; a < s_flags.aliasFlags.size(); ++a)
+        if (s_flags.aliasFlags[a] == flag)
+            return s_flags.aliases[a];
+    return flag < s_flags.specs.size() ? s_flags.specs[flag] : "#" + std::to_string(flag);
+}
+
+AP_ENGINE std::string errorMessage(const Error& error)
+{
+    switch (error.code) {
+    case Error::WrongValue:
+        return "Wrong value '" + s_argv[error.token] + "' of flag '" + s_argv[s_flags.flagTokens[error.flag]] + "'.";
+    case Error::MissingFlag:
+        return "Missing required flag '" + flagName(error.flag) + "'.";
+    case Error::ExclusiveFlag:
+        return "Flag '" + s_argv[error.token] + "' cannot be used together with the other flags of its group.";
+    case Error::MissingDependency:
+        return "Flag '" + s_argv[error.token] + "' requires flag '" + flagName(error.flag) + "'.";
+    case Error::WrongFile:
+        return "Cannot read file '" + s_argv[error.token].substr(1) + "' of flag '" + s_argv[s_flags.flagTokens[error.flag]] + "'.";
+    case Error::UnknownFlag:
+        return "Unknown flag '" + s_constraints.names[error.flag] + "' in the constraints.";
+    case Error::DuplicateKey:
+        return "Duplicate key '" + s_argv[error.token].substr(0, s_argv[error.token].find_first_of(s_long_flag_delimiter)) + "' of flag '" + s_argv[s_flags.flagTokens[error.flag]] + "'.";
+    }
+    return "Unknown error.";
+}
+
+/* Drops every flag, constraint and error, but keeps the tokens. */
+AP_ENGINE void clearFlags()
+{
+    s_flags.clear();
+    s_constraints.clear();
+    s_errors.clear();
+    ++s_generation;
+#if defined(AP_PROFILE)
+    s_profile.clear();
+#endif // defined(AP_PROFILE)
+}
+
+/* Drops every token, flag and error. */
+AP_ENGINE void reset()
+{
+    s_argv.clear();
+    s_argv_hashes.clear();
+    s_argv_parsed.clear();
+    s_argv_joined.clear();
+    s_parsed_count = 0;
+    s_first_token = 1;
+    clearFlags();
+    s_help = false;
+    s_help_format = HelpFormat::Text;
+}
+
+/* Starts the spec mode of the reserved first argument, where the flag
+ * definitions write their specs in another format instead of the help:
+ *  '--__complete WORDS...' writes the candidates of the last word. With an
+ *      embedded table it answers from that and exits before any definition.
+ *  '--__complete-script SHELL' writes the bash, zsh or fish script, which
+ *      calls '--__complete'.
+ *  '--__complete-table [NAME]' writes the table rows of the flags.
+ *  '--__help-blob' writes the help as string literal lines, where the
+ *      program is '%p'.
+ *  '--__help-man [NAME]' and '--__help-markdown [NAME]' write the manual
+ *      page and the markdown of the help.
+ * The generators take the name of the program, which they are built for. */
+AP_ENGINE bool startSpecMode(int argc, const char* const* argv, const Completion* first, const Completion* last)
+{
+    s_help_format = HelpFormat::Text;
+    if (argc < 2 || std::strncmp(argv[1], "--__", 4))
+        return false;
+
+    const std::string mode(argv[1]);
+    if (mode == "--__complete") {
+        s_help_format = HelpFormat::Complete;
+        s_complete_word = argc > 2 ? argv[argc - 1] : "";
+        s_complete_prev = argc > 3 ? argv[argc - 2] : "";
+        if (first != last) {
+            writeOut(completeTable(first, last));
+            std::exit(0);
+        }
+        return true;
+    }
+    if (mode == "--__complete-script") {
+        s_help_format = HelpFormat::CompletionScript;
+        s_complete_word = argc > 2 ? argv[2] : "";
+        return true;
+    }
+
+    if (mode == "--__complete-table")
+        s_help_format = HelpFormat::CompletionTable;
+    else if (mode == "--__help-blob")
+        s_help_format = HelpFormat::HelpBlob;
+    else if (mode == "--__help-man")
+        s_help_format = HelpFormat::Man;
+    else if (mode == "--__help-markdown")
+        s_help_format = HelpFormat::Markdown;
+    else
+        return false;
+    if (HelpFormat::HelpBlob == s_help_format)
+        s_argv[0] = "%p";
+    else if (argc > 2)
+        s_argv[0] = argv[2];
+    return true;
+}
+
+/* Returns the head of the help: the usage, or the pre-rendered help 'text'
+ * which is written instead of the whole help. The manual page and the
+ * markdown have one title per process, the usage of a later parser goes
+ * into their options. */
+AP_ENGINE std::string helpUsage(const std::string& usage, const char* text)
+{
+    if (text && HelpFormat::Text == s_help_format) {
+        s_help_format = HelpFormat::Written;
+        return REPLACE_PATTERN(text, "%p", s_argv[0]);
+    }
+
+    const std::string help = PTRNS(usage, "") + "\n";
+    const std::string name = s_argv[0].substr(s_argv[0].find_last_of('/') + 1);
+    switch (s_help_format) {
+    case HelpFormat::Text:
+        return help;
+    case HelpFormat::CompletionScript:
+        return completionScript();
+    case HelpFormat::HelpBlob:
+        return helpBlob(help);
+    case HelpFormat::Man: {
+        if (s_help_header)
+            return ".PP\n.nf\n" + escapeRoff(help) + ".fi\n";
+        s_help_header = true;
+        std::string title = name;
+        for (size_t i = 0; i < title.size(); ++i)
+            title[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(title[i])));
+        return ".TH " + escapeRoff(title) + " 1\n.SH NAME\n" + escapeRoff(name) + "\n.SH SYNOPSIS\n.nf\n" + escapeRoff(help) + ".fi\n.SH OPTIONS\n";
+    }
+    case HelpFormat::Markdown:
+        if (s_help_header)
+            return "```\n" + help + "```\n\n";
+        s_help_header = true;
+        return "# " + name + "\n\n```\n" + help + "```\n\n";
+    default:
+        return std::string();
+    }
+}
+
+/* Returns the help of a flag. The text is the spec and the lines of the
+ * message aligned to the 's_alignment' column. */
+AP_ENGINE std::string helpFlag(const std::string& flags, const std::string& def, const std::string& msg)
+{
+    if (HelpFormat::Complete == s_help_format || HelpFormat::CompletionTable == s_help_format)
+        return completions(flags, def, PTRNS(msg, def));
+
+    const std::string spec = PTRNS(flags, def);
+    const std::string helpText = PTRNS(msg, def);
+    const int size = s_alignment - static_cast<int>(spec.size()) - 2;
+    std::string help = HelpFormat::Man == s_help_format ? ".TP\n.B " + escapeRoff(spec) + "\n" : HelpFormat::Markdown == s_help_format ? "- `" + spec + "`" : "  " + spec;
+    for (size_t begin = 0, end = 0, i = 0; begin < helpText.size(); begin = end + 1, ++i) {
+        end = helpText.find('\n', begin);
+        if (std::string::npos == end)
+            end = helpText.size();
+        size_t indent = helpText.find_first_not_of(' ', begin);
+        if (indent > end)
+            indent = end;
+        if (HelpFormat::Man == s_help_format)
+            help += (i ? ".br\n" : "") + escapeRoff(helpText.substr(indent, end - indent)) + "\n";
+        else if (HelpFormat::Markdown == s_help_format)
+            help.append(i ? "  \n  " : " ").append(helpText, indent, end - indent);
+        else
+            help.append(i ? s_alignment : (size > 1 ? size : 2), ' ').append(helpText, indent, end - indent).append("\n");
+    }
+
+    switch (s_help_format) {
+    case HelpFormat::Text:
+    case HelpFormat::Man:
+        return help;
+    case HelpFormat::HelpBlob:
+        return helpBlob(help);
+    case HelpFormat::Markdown:
+        return help + "\n";
+    default:
+        return std::string();
+    }
+}
+
+/* Returns the help of an ADD_MSG message. */
+AP_ENGINE std::string helpMessage(const std::string& msg)
+{
+    const std::string help = PTRNS(msg, "") + "\n";
+    switch (s_help_format) {
+    case HelpFormat::Text:
+        return help;
+    case HelpFormat::HelpBlob:
+        return helpBlob(help);
+    case HelpFormat::Man:
+        return ".PP\n.nf\n" + escapeRoff(help) + ".fi\n";
+    case HelpFormat::Markdown: {
+        std::string lines;
+        for (size_t begin = 0, end = 0; begin + 1 < help.size(); begin = end + 1) {
+            end = help.find('\n', begin);
+            lines += help.substr(begin, end - begin) + (end > begin ? "  \n" : "\n");
+        }
+        return lines + "\n";
+    }
+    default:
+        return std::string();
+    }
+}
+
+/* Returns the text as string literal lines. */
+AP_ENGINE std::string helpBlob(const std::string& text)
+{
+    std::string blob;
+    for (size_t begin = 0, end = 0; begin < text.size(); begin = end + 1) {
+        end = text.find('\n', begin);
+        if (std::string::npos == end)
+            end = text.size();
+        blob += "\"" + escapeQuotes(text.substr(begin, end - begin)) + (end < text.size() ? "\\n" : "") + "\"\n";
+    }
+    return blob;
+}
+
+/* Escapes the backslashes, the dashes and the requests at the line starts. */
+AP_ENGINE std::string escapeRoff(const std::string& text)
+{
+    std::string escaped;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if ((!i || text[i - 1] == '\n') && (text[i] == '.' || text[i] == '\''))
+            escaped += "\\&";
+        if (text[i] == '\\')
+            escaped += "\\e";
+        else if (text[i] == '-')
+            escaped += "\\-";
+        else
+            escaped += text[i];
+    }
+    return escaped;
+}
+
+/* Returns the completions of a flag in the current spec mode: a table row
+ * per alias, or the candidates of the completed word. The help flag is not
+ * defined, it is taken as a bool. An alias is completed once per process,
+ * also when more parsers define it. */
+AP_ENGINE std::string completions(const std::string& flags, const std::string& def, const std::string& msg)
+{
+    std::vector<std::string> aliases;
+    SEPARATE_FLAGS(flags, aliases);
+    const size_t index = s_flags.findSpec(flags, hashToken(flags));
+    const bool isBool = !index || testBit(s_flags.isBool, index);
+    const std::string spec = PTRNS(flags, def);
+    std::string value = spec.substr(spec.find_last_of(',') + 1);
+    TRIM_SPACES(value);
+    const size_t space = value.find_last_of(" \t");
+    value = std::string::npos == space ? std::string() : value.substr(space + 1);
+    std::string brief = msg.substr(0, msg.find('\n'));
+    TRIM_SPACES(brief);
+
+    std::string out;
+    for (const std::string& alias : aliases) {
+        size_t completed = 0;
+        while (completed < s_completed_aliases.size() && s_completed_aliases[completed] != alias)
+            ++completed;
+        if (alias.empty() || completed < s_completed_aliases.size())
+            continue;
+        s_completed_aliases.push_back(alias);
+        if (HelpFormat::Complete == s_help_format)
+            completeAlias({ alias.c_str(), value.c_str(), brief.c_str(), isBool }, out);
+        else
+            out += "{ \"" + escapeQuotes(alias) + "\", \"" + escapeQuotes(value) + "\", \"" + escapeQuotes(brief) + "\", " + (isBool ? "true" : "false") + " },\n";
+    }
+    return out;
+}
+
+/* Appends the candidates of the completed word from an alias: the alias for
+ * its prefix, or the choices of its value after it, also in the joined
+ * '--flag=value' form. A candidate line is 'CANDIDATE<tab>BRIEF'. */
+AP_ENGINE void completeAlias(const Completion& alias, std::string& candidates)
+{
+    const std::string& word = s_complete_word;
+    const char* name = alias.alias;
+    size_t i = 0;
+    while (name[i] && i < word.size() && name[i] == word[i])
+        ++i;
+
+    size_t typed = 0;
+    if (!alias.isBool && !name[i] && i < word.size() && std::string::npos != s_long_flag_delimiter.find(word[i])) {
+        typed = i + 1;
+    } else if (!alias.isBool && name[0] == s_complete_prev[0] && s_complete_prev == name) {
+        typed = 0;
+    } else {
+        if (i && i == word.size())
+            candidates.append(name).append("\t").append(alias.brief).append("\n");
+        return;
+    }
+
+    if (!std::strchr(alias.value, '|'))
+        return;
+    for (const char* choice = alias.value; *choice;) {
+        const size_t size = std::strcspn(choice, "|");
+        if (size && size >= word.size() - typed && !word.compare(typed, std::string::npos, choice, word.size() - typed))
+            candidates.append(word, 0, typed).append(choice, size).append("\t").append(alias.brief).append("\n");
+        choice += size + !!choice[size];
+    }
+}
+
+AP_ENGINE std::string completeTable(const Completion* first, const Completion* last)
+{
+    std::string candidates;
+    for (; first != last; ++first)
+        completeAlias(*first, candidates);
+    return candidates;
+}
+
+/* Returns the completion script of the shell, it is empty for an unknown
+ * shell. Every shell passes the words up to the cursor to '--__complete'. */
+AP_ENGINE std::string completionScript()
+{
+    if (HelpFormat::CompletionScript != s_help_format)
+        return std::string();
+
+    std::string script;
+    if ("bash" == s_complete_word)
+        script = "_ap_complete_%p()\n"
+                 "{\n"
+                 "    local words line=\"${COMP_LINE:0:$COMP_POINT}\"\n"
+                 "    read -ra words <<< \"$line\"\n"
+                 "    [[ \"$line\" == *[[:space:]] ]] && words+=(\"\")\n"
+                 "    local IFS=$'\\n' word=\"${words[${#words[@]}-1]}\"\n"
+                 "    COMPREPLY=($(\"${words[0]}\" --__complete \"${words[@]:1}\" 2>/dev/null | cut -f1))\n"
+                 "    [[ \"$word\" == *=* ]] && COMPREPLY=(\"${COMPREPLY[@]#*=}\")\n"
+                 "}\n"
+                 "complete -o default -F _ap_complete_%p %p\n";
+    else if ("zsh" == s_complete_word)
+        script = "#compdef %p\n"
+                 "_ap_complete_%p()\n"
+                 "{\n"
+                 "    local line\n"
+                 "    local -a candidates\n"
+                 "    for line in \"${(@f)$(\"${words[1]}\" --__complete \"${(@)words[2,CURRENT]}\" 2>/dev/null)}\"; do\n"
+                 "        [[ -n \"$line\" ]] && candidates+=(\"${${line%%$'\\t'*}//:/\\\\:}:${line#*$'\\t'}\")\n"
+                 "    done\n"
+                 "    if (( ${#candidates} )); then\n"
+                 "        _describe 'option' candidates\n"
+                 "    else\n"
+                 "        _files\n"
+                 "    fi\n"
+                 "}\n"
+                 "compdef _ap_complete_%p %p\n";
+    else if ("fish" == s_complete_word)
+        script = "function __ap_complete_%p\n"
+                 "    set -l words (commandline -opc)\n"
+                 "    set -l command $words[1]\n"
+                 "    set -e words[1]\n"
+                 "    set -l word (commandline -ct)\n"
+                 "    $command --__complete $words \"$word\"\n"
+                 "end\n"
+                 "complete -c %p -a '(__ap_complete_%p)'\n";
+    const std::string path = s_argv.empty() ? std::string() : s_argv[0];
+    return REPLACE_PATTERN(script, "%p", path.substr(path.find_last_of('/') + 1));
+}
+
+/* Escapes the quotes, backslashes and tabs of a string literal, drops the
+ * other control characters. */
+AP_ENGINE std::string escapeQuotes(const std::string& str)
+{
+    std::string escaped;
+    for (size_t i = 0; i < str.size(); ++i) {
+        if (str[i] == '"' || str[i] == '\\')
+            escaped += '\\';
+        if (str[i] == '\t')
+            escaped += "\\t";
+        else if (static_cast<unsigned char>(str[i]) >= 0x20)
+            escaped += str[i];
+    }
+    return escaped;
+}
+
+#if defined(AP_PROFILE)
+AP_ENGINE const char* phaseName(ProfileRecord::Phase phase)
+{
+    const char* names[] = { "copy-argv", "lookup", "convert", "parse-arg", "help", "validate" };
+    return names[phase];
+}
+
+/* The tokens and flags of a record of an earlier PARSE_HELP are gone, it is
+ * named by its index only. */
+AP_ENGINE std::string recordName(const ProfileRecord& record)
+{
+    const bool current = record.generation == s_generation;
+    switch (record.phase) {
+    case ProfileRecord::CopyArgv: return std::to_string(record.index) + " args";
+    case ProfileRecord::ParseArg: return !record.index ? "" : current && record.index < s_argv.size() ? s_argv[record.index] : "#" + std::to_string(record.index);
+    case ProfileRecord::Validate: return std::to_string(record.index) + " errors";
+    default: return current ? flagName(record.index) : "#" + std::to_string(record.index);
+    }
+}
+
+/* Reports the records of the last PARSE_HELP, or with AP_TRACE alone the
+ * records of the trace ring. */
+AP_ENGINE std::string profileReport(size_t count)
+{
+#if defined(AP_TRACE_ONLY)
+    std::vector<ProfileRecord> records;
+    for (size_t i = s_trace.count > AP_TRACE_EVENTS ? s_trace.count - AP_TRACE_EVENTS : 0; i < s_trace.count; ++i)
+        records.push_back(s_trace.events[i % AP_TRACE_EVENTS].record);
+#else
+    const std::vector<ProfileRecord>& records = s_profile;
+#endif // defined(AP_TRACE_ONLY)
+    struct { uint64_t ns; uint64_t allocations; size_t records; } totals[ProfileRecord::PhaseCount] = {};
+    for (const ProfileRecord& record : records) {
+        totals[record.phase].ns += record.ns;
+        totals[record.phase].allocations += record.allocations;
+        totals[record.phase].records++;
+    }
+
+    char line[256];
+    std::string report = "Parser profile:\n";
+    for (int phase = ProfileRecord::CopyArgv; phase < ProfileRecord::PhaseCount; ++phase) {
+        std::snprintf(line, sizeof(line), "  %-12s%12llu ns%8llu allocs%8zu records\n", phaseName(ProfileRecord::Phase(phase)),
+            (unsigned long long)totals[phase].ns, (unsigned long long)totals[phase].allocations, totals[phase].records);
+        report += line;
+    }
+
+    std::vector<ProfileRecord> slowest(records);
+    std::sort(slowest.begin(), slowest.end(), [](const ProfileRecord& a, const ProfileRecord& b) { return a.ns > b.ns; });
+    report += "Slowest:\n";
+    for (size_t i = 0; i < count && i < slowest.size(); ++i) {
+        std::snprintf(line, sizeof(line), "  %-12s%-*s%12llu ns%8llu allocs\n", phaseName(slowest[i].phase), ap::s_alignment, recordName(slowest[i]).c_str(),
+            (unsigned long long)slowest[i].ns, (unsigned long long)slowest[i].allocations);
+        report += line;
+    }
+    return report;
+}
+#endif // defined(AP_PROFILE)
+
+#if defined(AP_TRACE)
+/* Writes the ring as complete ('X') events on the steady clock, in
+ * microseconds, so it can be merged with other traces of the process. */
+AP_ENGINE void writeTrace()
+{
+    if (!s_trace.path || !s_trace.count)
+        return;
+
+    std::FILE* out = std::fopen(s_trace.path, "w");
+    if (!out)
+        return;
+    std::fputs("{\"traceEvents\": [", out);
+    const size_t first = s_trace.count > AP_TRACE_EVENTS ? s_trace.count - AP_TRACE_EVENTS : 0;
+    for (size_t i = first; i < s_trace.count; ++i) {
+        const TraceRing::Event& event = s_trace.events[i % AP_TRACE_EVENTS];
+        std::fprintf(out, "%s{\"name\": \"%s\", \"cat\": \"arg-parser\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": %d, \"tid\": 0"
+            ", \"args\": {\"name\": \"%s\", \"allocations\": %llu}}", i != first ? ",\n" : "\n", phaseName(event.record.phase),
+            event.start / 1000.0, event.record.ns / 1000.0, int(getpid()), escapeQuotes(recordName(event.record)).c_str(), (unsigned long long)event.record.allocations);
+    }
+    std::fputs("\n]}\n", out);
+    std::fclose(out);
+    s_trace.count = 0;
+}
+#endif // defined(AP_TRACE)
+
+#endif // !defined(AP_LIBRARY) || defined(AP_IMPLEMENTATION)
+
 } // namespace ap
 
+#if defined(AP_PROFILE) && !defined(AP_PROFILE_NO_NEW) && (!defined(AP_LIBRARY) || defined(AP_IMPLEMENTATION))
+/* Counts the allocations of the profiled phases. Define AP_PROFILE_NO_NEW
+ * when the application replaces the global 'operator new' itself, and
+ * increment 'ap::s_profile_allocations' there. They are never inlined, so
+ * GCC does not see a 'free()' of a pointer of 'operator new'. */
+#if defined(__GNUC__)
+#define AP_NOINLINE __attribute__((noinline))
+#else
+#define AP_NOINLINE
+#endif
+AP_NOINLINE void* operator new(size_t size)
+{
+    ap::s_profile_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+AP_NOINLINE void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+AP_NOINLINE void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+AP_NOINLINE void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+#undef AP_NOINLINE
+#endif // defined(AP_PROFILE) && !defined(AP_PROFILE_NO_NEW) && (!defined(AP_LIBRARY) || defined(AP_IMPLEMENTATION))
+
 #endif // ARG_PARSER_H
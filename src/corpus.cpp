@@ -0,0 +1,167 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "arg-parser.h"
+
+#include <iostream>
+#include <random>
+
+/* Synthetic argv corpus for the parser benchmarks. Every line is one argv
+ * (without the program name) of shell quoted tokens. The defined flags are
+ * '-fN, --flag-N' where every flag is a bool or takes a value, see '--specs'.
+ * The same options and seed always give the same corpus. */
+
+namespace {
+
+class Random {
+public:
+    explicit Random(uint64_t seed) : _engine(seed) {}
+
+    /* The std distributions differ by implementation, these do not. */
+    size_t below(size_t n) { return n ? _engine() % n : 0; }
+    bool chance(double p) { return (_engine() >> 11) * (1.0 / 9007199254740992.0) < p; }
+
+private:
+    std::mt19937_64 _engine;
+};
+
+struct Corpus {
+    uint64_t seed;
+    size_t count;
+    size_t length;
+    size_t flags;
+    double bools;
+    double positionals;
+    double joined;
+    double aliases;
+    double clusters;
+    double longValues;
+    size_t valueLength;
+    double unknown;
+
+    bool isBool(size_t flag) const { return Random(seed ^ (flag * 0x9e3779b97f4a7c15ull)).chance(bools); }
+};
+
+std::string quote(const std::string& token)
+{
+    if (!token.empty() && token.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_./=:,+-") == std::string::npos)
+        return token;
+    std::string quoted = "'";
+    for (size_t i = 0; i < token.size(); ++i)
+        quoted += token[i] == '\'' ? std::string("'\\''") : std::string(1, token[i]);
+    return quoted + "'";
+}
+
+std::string value(const Corpus& corpus, Random& random)
+{
+    if (!random.chance(corpus.longValues))
+        return std::to_string(random.below(100000));
+    const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789/._- ";
+    std::string str;
+    for (size_t i = 0; i < corpus.valueLength; ++i)
+        str += chars[random.below(sizeof(chars) - 1)];
+    return str;
+}
+
+void pushFlag(const Corpus& corpus, Random& random, size_t flag, std::vector<std::string>& argv)
+{
+    const std::string name = random.chance(corpus.aliases) ? "-f" + std::to_string(flag) : "--flag-" + std::to_string(flag);
+    if (corpus.isBool(flag)) {
+        argv.push_back(name);
+    } else if (random.chance(corpus.joined)) {
+        argv.push_back(name + "=" + value(corpus, random));
+    } else {
+        argv.push_back(name);
+        argv.push_back(value(corpus, random));
+    }
+}
+
+std::vector<std::string> generate(const Corpus& corpus, Random& random)
+{
+    std::vector<std::string> argv;
+    while (argv.size() < corpus.length) {
+        if (!corpus.flags || random.chance(corpus.positionals)) {
+            argv.push_back(value(corpus, random));
+        } else if (random.chance(corpus.unknown)) {
+            argv.push_back("--unknown-" + std::to_string(random.below(corpus.flags)));
+        } else if (random.chance(corpus.clusters)) {
+            /* A run of bool flags. */
+            for (size_t n = 2 + random.below(7), tries = 0; n && tries < 8 * corpus.flags; ++tries) {
+                const size_t flag = random.below(corpus.flags);
+                if (corpus.isBool(flag)) {
+                    pushFlag(corpus, random, flag, argv);
+                    --n;
+                }
+            }
+        } else {
+            pushFlag(corpus, random, random.below(corpus.flags), argv);
+        }
+    }
+    return argv;
+}
+
+} // namespace anonymous
+
+int main(int argc, char* argv[])
+{
+    Corpus corpus;
+    bool help             = PARSE_HELP("-h, --help", "show this help.", "Arg-parser argv corpus generator\nUsage: %p [options]\n\nOptions:", argc, argv);
+    corpus.seed           = PARSE_FLAG("-s, --seed SEED", uint64_t(1), "seed of the generator. Default is '%d'.");
+    corpus.count          = PARSE_FLAG("-n, --count N", size_t(10), "number of argvs. Default is '%d'.");
+    corpus.length         = PARSE_FLAG("-l, --length N", size_t(20), "minimal number of tokens of an argv. Default is '%d'.");
+    corpus.flags          = PARSE_FLAG("-f, --flags N", size_t(100), "number of defined flags. Default is '%d'.");
+    bool specs            = PARSE_FLAG("--specs", false, "print the flag specs instead of argvs.");
+    ADD_MSG("\nDistributions (probabilities):");
+    corpus.bools          = PARSE_FLAG("--bools P", 0.3, "of a defined flag to be a bool. Default is '%d'.");
+    corpus.positionals    = PARSE_FLAG("--positionals P", 0.2, "of a positional argument. Default is '%d'.");
+    corpus.joined         = PARSE_FLAG("--joined P", 0.3, "of a '--key=value' value. Default is '%d'.");
+    corpus.aliases        = PARSE_FLAG("--aliases P", 0.3, "of using the '-fN' alias. Default is '%d'.");
+    corpus.clusters       = PARSE_FLAG("--clusters P", 0.1, "of a run of 2-8 bool flags. Default is '%d'.");
+    corpus.longValues     = PARSE_FLAG("--long-values P", 0.05, "of a long string value. Default is '%d'.");
+    corpus.valueLength    = PARSE_FLAG("--value-length N", size_t(256), "length of long values. Default is '%d'.");
+    corpus.unknown        = PARSE_FLAG("--unknown P", 0.02, "of an undefined flag. Default is '%d'.");
+    if (help)
+        return 0;
+    if (ERROR_COUNT()) {
+        for (size_t i = 0; i < ERROR_COUNT(); ++i)
+            std::cerr << ERROR_MSG(i) << std::endl;
+        return 1;
+    }
+
+    if (specs) {
+        for (size_t flag = 0; flag < corpus.flags; ++flag)
+            std::cout << "-f" << flag << ", --flag-" << flag << (corpus.isBool(flag) ? "" : " VALUE") << std::endl;
+        return 0;
+    }
+
+    Random random(corpus.seed);
+    for (size_t i = 0; i < corpus.count; ++i) {
+        const std::vector<std::string> tokens = generate(corpus, random);
+        for (size_t t = 0; t < tokens.size(); ++t)
+            std::cout << (t ? " " : "") << quote(tokens[t]);
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -24,7 +24,7 @@
 
 int option_main(int argc, char* argv[]);
 
-#include "arg-parser.h"
+#include "arg-parser-stream.h"
 
 int main(int argc, char* argv[])
 {
@@ -91,20 +91,19 @@ public:
         ap::s_alignment = 30;
         std::string usage("Arg-parser Demo *** Singleton version *** (C) 2018. Szilard Ledan\nUsage: %p [options] name number [number...]\n\nOptions:");
         m_help      = PARSE_HELP("-h, --help, --usage", "show this help.", usage, argc, argv);
-        /* Parse flags. */
-        m_frequency = PARSE_FLAG("-f, --frequency FREQ", 60, "set rendering frequency.\n Default is '%d', but '%d' is not the best.");
-        m_Frequency = PARSE_FLAG("+f, ++frequency FREQ", 25, "set refreshing frequency. Default is '%d'.");
-        m_size      = PARSE_FLAG("--size SIZE", 300, "set size of window. Default is '%d'.");
-        m_lineWidth = PARSE_FLAG("-w, --line-width LW", 3.14f, "set width of line. Default is '%d'.");
-        m_path      = PARSE_FLAG("-p, --path PATH", std::string("./build"), "set working dir. Default is '%d'.");
-        m_dot       = PARSE_FLAG("-d DOT", '.', "set separate char. Default is '%d'.");
-        m_enable    = PARSE_FLAG("-e, --enable", false, "enable something.");
-        /* Parse arguments. */
-        m_from      = PARSE_ARG(m_from);
-        m_to.push_back(PARSE_ARG(3));
-        while (!m_help && UNPARSED_COUNT()) {
-            m_to.push_back(PARSE_ARG(0));
-        }
+        /* Parse flags and arguments straight into the members. */
+        static const ap::Field<Options> fields[] = {
+            BIND_FLAG(Options, m_frequency, "-f, --frequency FREQ", "set rendering frequency.\n Default is '%d', but '%d' is not the best."),
+            BIND_FLAG(Options, m_Frequency, "+f, ++frequency FREQ", "set refreshing frequency. Default is '%d'."),
+            BIND_FLAG(Options, m_size,      "--size SIZE", "set size of window. Default is '%d'."),
+            BIND_FLAG(Options, m_lineWidth, "-w, --line-width LW", "set width of line. Default is '%d'."),
+            BIND_FLAG(Options, m_path,      "-p, --path PATH", "set working dir. Default is '%d'."),
+            BIND_FLAG(Options, m_dot,       "-d DOT", "set separate char. Default is '%d'."),
+            BIND_FLAG(Options, m_enable,    "-e, --enable", "enable something."),
+            BIND_ARG(Options, m_from),
+            BIND_ARG(Options, m_to),
+        };
+        PARSE_STRUCT(fields, *this);
 
         return *this;
     }
@@ -118,7 +117,7 @@ public:
     char m_dot = '.';
     bool m_enable = false;
     std::string m_from = "ABC";
-    std::vector<int> m_to;
+    std::vector<int> m_to = { 3 };
 
     std::stringstream m_optionStream;
 private:
@@ -0,0 +1,101 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test.hpp"
+#include "test-defs.hpp"
+
+#include <set>
+#include <vector>
+
+namespace testargparse {
+namespace {
+
+/* Collects the cases of a three dimensional matrix as single numbers. */
+std::vector<size_t> collectCases(const Combinations::Coverage& coverage, const size_t& shard, const size_t& shards)
+{
+    size_t a = 0, b = 0, c = 0;
+    std::vector<size_t> cases;
+    for (Combinations combinations(coverage, { { &a, 3 }, { &b, 4 }, { &c, 2 } }, shard, shards); combinations.next(); )
+        cases.push_back((a * 4 + b) * 2 + c);
+    return cases;
+}
+
+TestContext::Return testExhaustiveCases(TestContext* ctx)
+{
+    const std::vector<size_t> cases = collectCases(Combinations::Exhaustive, 0, 1);
+    if (TAP_CHECK(ctx, cases.size() != 3 * 4 * 2))
+        return TAP_FAIL(ctx, "The exhaustive coverage runs every case.");
+    for (size_t i = 0; i < cases.size(); ++i)
+        if (TAP_CHECK(ctx, cases[i] != i))
+            return TAP_FAIL(ctx, "The last dimension changes the fastest.");
+
+    return TAP_PASS(ctx, "The exhaustive coverage runs every case in order.");
+}
+
+TestContext::Return testPairwiseCases(TestContext* ctx)
+{
+    const std::vector<size_t> cases = collectCases(Combinations::Pairwise, 0, 1);
+    if (TAP_CHECK(ctx, cases.empty() || cases.size() >= 3 * 4 * 2))
+        return TAP_FAIL(ctx, "The pairwise coverage runs fewer cases.");
+
+    std::set<size_t> ab, ac, bc;
+    for (const size_t& value : cases) {
+        const size_t a = value / 8, b = value / 2 % 4, c = value % 2;
+        ab.insert(a * 4 + b);
+        ac.insert(a * 2 + c);
+        bc.insert(b * 2 + c);
+    }
+    if (TAP_CHECK(ctx, ab.size() != 3 * 4 || ac.size() != 3 * 2 || bc.size() != 4 * 2))
+        return TAP_FAIL(ctx, "The pairwise coverage misses a value pair.");
+
+    return TAP_PASS(ctx, "The pairwise coverage covers every value pair.");
+}
+
+TestContext::Return testShards(TestContext* ctx)
+{
+    const Combinations::Coverage coverages[] = { Combinations::Exhaustive, Combinations::Pairwise };
+    for (const Combinations::Coverage& coverage : coverages) {
+        const std::vector<size_t> whole = collectCases(coverage, 0, 1);
+        std::vector<size_t> merged;
+        for (size_t shard = 0; shard < 3; ++shard) {
+            const std::vector<size_t> cases = collectCases(coverage, shard, 3);
+            merged.insert(merged.end(), cases.begin(), cases.end());
+        }
+        if (TAP_CHECK(ctx, std::multiset<size_t>(merged.begin(), merged.end()) != std::multiset<size_t>(whole.begin(), whole.end())))
+            return TAP_FAIL(ctx, "The shards run every case exactly once.");
+    }
+
+    return TAP_PASS(ctx, "The shards divide the cases.");
+}
+
+} // namespace anonymous
+
+void harnessTests(TestContext* ctx)
+{
+    ctx->add(testExhaustiveCases);
+    ctx->add(testPairwiseCases);
+    ctx->add(testShards);
+}
+
+} // namespace testargparse
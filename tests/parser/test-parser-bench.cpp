@@ -0,0 +1,64 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test-parser.hpp"
+
+namespace testargparse {
+namespace {
+
+TestContext::Return benchParseFlags(TestContext* ctx)
+{
+    const size_t flagCount = 32;
+    std::vector<std::string> specs;
+    std::vector<std::string> tokens(1, "test");
+    for (size_t i = 0; i < flagCount; ++i) {
+        specs.push_back("--flag" + std::to_string(i) + " N");
+        tokens.push_back("--flag" + std::to_string(i));
+        tokens.push_back(std::to_string(i));
+    }
+    std::vector<const char*> argv;
+    for (const std::string& token : tokens)
+        argv.push_back(token.c_str());
+
+    size_t sum = 0;
+    const TestContext::Return ret = TAP_BENCH(ctx, "parse-32-flags", 2000,
+        ap::reset();
+        PARSE_HELP("-h, --help", "show this help.", "Usage: %p", static_cast<int>(argv.size()), argv.data());
+        for (const std::string& spec : specs)
+            sum += PARSE_FLAG(spec.c_str(), size_t(0), "a flag."));
+
+    if (TAP_CHECK(ctx, sum != 2000 * flagCount * (flagCount - 1) / 2))
+        return TAP_FAIL(ctx, "Every flag has to be parsed in every iteration.");
+
+    return ret;
+}
+
+} // namespace anonymous
+
+void parserBenchTests(TestContext* ctx)
+{
+    ctx->add(benchParseFlags);
+}
+
+} // namespace testargparse
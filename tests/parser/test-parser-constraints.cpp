@@ -0,0 +1,158 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test-parser.hpp"
+
+namespace testargparse {
+namespace {
+
+TestContext::Return testDeclaredBeforeFlags(TestContext* ctx)
+{
+    parseTokens({ "-a", "-b" });
+
+    REQUIRE_FLAG("-a");
+    DEPEND_FLAG("-b", "-a");
+    PARSE_FLAG("-a", false, "a.");
+    PARSE_FLAG("-b", false, "b.");
+
+    if (TAP_CHECK(ctx, !CHECK_CONSTRAINTS() || ERROR_COUNT()))
+        return TAP_FAIL(ctx, "The constraints have to be resolved when they are checked.");
+
+    return TAP_PASS(ctx, "Constraints can be declared before their flags.");
+}
+
+TestContext::Return testViolations(TestContext* ctx)
+{
+    parseTokens({ "-b", "-c", "-x" });
+
+    PARSE_FLAG("-a", false, "a.");
+    PARSE_FLAG("-b", false, "b.");
+    PARSE_FLAG("-c", false, "c.");
+    PARSE_FLAG("-d", false, "d.");
+    PARSE_FLAG("-x", false, "x.");
+    REQUIRE_FLAG("-a");
+    EXCLUDE_FLAGS("-x", "-b", "-d");
+    DEPEND_FLAG("-c", "-d");
+
+    if (TAP_CHECK(ctx, CHECK_CONSTRAINTS() || ERROR_COUNT() != 3))
+        return TAP_FAIL(ctx, "Every violation has to be recorded.");
+    TAP_CHECK_ERROR(ctx, 0, "Missing required flag '-a'.");
+    TAP_CHECK_ERROR(ctx, 1, "Flag '-x' cannot be used together with the other flags of its group.");
+    TAP_CHECK_ERROR(ctx, 2, "Flag '-c' requires flag '-d'.");
+
+    return TAP_PASS(ctx, "Constraint violations are recorded.");
+}
+
+TestContext::Return testUnknownNames(TestContext* ctx)
+{
+    parseTokens({ "-a" });
+
+    PARSE_FLAG("-a, --all", false, "all.");
+    REQUIRE_FLAG("--all");
+    EXCLUDE_FLAGS("-a", "--typo");
+
+    if (TAP_CHECK(ctx, CHECK_CONSTRAINTS() || ERROR_COUNT() != 1))
+        return TAP_FAIL(ctx, "An unknown name has to fail the check.");
+    TAP_CHECK_ERROR(ctx, 0, "Unknown flag '--typo' in the constraints.");
+
+    return TAP_PASS(ctx, "Unknown constraint names are errors.");
+}
+
+TestContext::Return testRepeatedChecks(TestContext* ctx)
+{
+    parseTokens({ "-a", "-b" });
+
+    PARSE_FLAG("-a", false, "a.");
+    REQUIRE_FLAG("--typo");
+
+    if (TAP_CHECK(ctx, CHECK_CONSTRAINTS() || ERROR_COUNT() != 1))
+        return TAP_FAIL(ctx, "The names have to be resolved by the first check.");
+    if (TAP_CHECK(ctx, CHECK_CONSTRAINTS() || ERROR_COUNT() != 1))
+        return TAP_FAIL(ctx, "An unknown name has to be recorded once.");
+
+    PARSE_FLAG("-b", false, "b.");
+    EXCLUDE_FLAGS("-a", "-b");
+    if (TAP_CHECK(ctx, CHECK_CONSTRAINTS() || ERROR_COUNT() != 2))
+        return TAP_FAIL(ctx, "A new rule has to be compiled by the next check.");
+    TAP_CHECK_ERROR(ctx, 0, "Unknown flag '--typo' in the constraints.");
+    TAP_CHECK_ERROR(ctx, 1, "Flag '-b' cannot be used together with the other flags of its group.");
+
+    DEPEND_FLAG("-b", "-c");
+    if (TAP_CHECK(ctx, CHECK_CONSTRAINTS() || ERROR_COUNT() != 4))
+        return TAP_FAIL(ctx, "A name which is not defined yet has to be recorded.");
+    TAP_CHECK_ERROR(ctx, 2, "Unknown flag '-c' in the constraints.");
+    PARSE_FLAG("-c", false, "c.");
+    if (TAP_CHECK(ctx, CHECK_CONSTRAINTS() || ERROR_COUNT() != 6))
+        return TAP_FAIL(ctx, "A new flag has to be resolved by the next check.");
+    TAP_CHECK_ERROR(ctx, 5, "Flag '-b' requires flag '-c'.");
+
+    parseTokens({ "-a" });
+    PARSE_FLAG("-a", false, "a.");
+    REQUIRE_FLAG("-a");
+    if (TAP_CHECK(ctx, !CHECK_CONSTRAINTS() || ERROR_COUNT()))
+        return TAP_FAIL(ctx, "PARSE_HELP has to drop the compiled constraints.");
+
+    return TAP_PASS(ctx, "Constraints are compiled once per change.");
+}
+
+TestContext::Return testErrorBuffer(TestContext* ctx)
+{
+    const size_t overflow = AP_MAX_ERRORS + 4;
+    std::vector<std::string> tokens(1, "test");
+    for (size_t i = 0; i < overflow; ++i) {
+        tokens.push_back("-n" + std::to_string(i));
+        tokens.push_back("x");
+    }
+    std::vector<const char*> argv;
+    for (const std::string& token : tokens)
+        argv.push_back(token.c_str());
+    ap::reset();
+    PARSE_HELP("-h", "help.", "Usage: %p", static_cast<int>(argv.size()), argv.data());
+
+    for (size_t i = 0; i < overflow; ++i)
+        READ_FLAG(("-n" + std::to_string(i) + " N").c_str(), 0);
+
+    if (TAP_CHECK(ctx, ERROR_COUNT() != AP_MAX_ERRORS || ap::s_errors.dropped() != 4))
+        return TAP_FAIL(ctx, "The errors over AP_MAX_ERRORS have to be counted only.");
+    TAP_CHECK_ERROR(ctx, AP_MAX_ERRORS - 1, "Wrong value 'x' of flag '-n" + std::to_string(AP_MAX_ERRORS - 1) + "'.");
+
+    parseTokens({});
+    if (TAP_CHECK(ctx, ERROR_COUNT() || ap::s_errors.dropped()))
+        return TAP_FAIL(ctx, "PARSE_HELP has to clear the errors.");
+
+    return TAP_PASS(ctx, "The error buffer keeps the first errors.");
+}
+
+} // namespace anonymous
+
+void parserConstraintsTests(TestContext* ctx)
+{
+    ctx->add(testDeclaredBeforeFlags);
+    ctx->add(testViolations);
+    ctx->add(testUnknownNames);
+    ctx->add(testRepeatedChecks);
+    ctx->add(testErrorBuffer);
+}
+
+} // namespace testargparse
@@ -0,0 +1,116 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test-parser.hpp"
+#include "arg-parser-file.h"
+
+#include <unistd.h>
+
+namespace testargparse {
+namespace {
+
+TestContext::Return testFileList(TestContext* ctx)
+{
+    parseTokens({ "-n", "1,2,x,3" });
+
+    const ap::FileArray<int> numbers = PARSE_FILE("-n LIST", ap::FileArray<int>(), "numbers.");
+    const ap::FileArray<int> none = PARSE_FILE("-m LIST", ap::FileArray<int>(ap::FileFormat::Text), "none.");
+
+    if (TAP_CHECK(ctx, std::vector<int>(numbers.begin(), numbers.end()) != std::vector<int>({ 1, 2, 3 })))
+        return TAP_FAIL(ctx, "The list of the value has to be split.");
+    if (TAP_CHECK(ctx, !none.empty() || ap::FileFormat::Text != none.format()))
+        return TAP_FAIL(ctx, "An unset flag has to return its default.");
+    if (TAP_CHECK(ctx, ERROR_COUNT() != 1))
+        return TAP_FAIL(ctx, "A wrong element has to be an error.");
+
+    return TAP_PASS(ctx, "PARSE_FILE reads the list of the value.");
+}
+
+TestContext::Return testTextFile(TestContext* ctx)
+{
+    const std::string path = writeTempFile("1\n\n-2\r\n\r\n30 \nx\n 4");
+    const std::string arg = "@" + path;
+    parseTokens({ "-n", arg.c_str() });
+
+    const ap::FileArray<long> numbers = PARSE_FILE("-n FILE", ap::FileArray<long>(ap::FileFormat::Text), "numbers.");
+    unlink(path.c_str());
+
+    if (TAP_CHECK(ctx, std::vector<long>(numbers.begin(), numbers.end()) != std::vector<long>({ 1, -2, 30, 4 })))
+        return TAP_FAIL(ctx, "The lines have to be converted and the empty ones skipped.");
+    if (TAP_CHECK(ctx, ERROR_COUNT() != 1))
+        return TAP_FAIL(ctx, "A wrong line has to be an error.");
+    TAP_CHECK_ERROR(ctx, 0, "Wrong value '" + arg + "' of flag '-n'.");
+
+    return TAP_PASS(ctx, "PARSE_FILE reads the lines of a text file.");
+}
+
+TestContext::Return testBinaryFile(TestContext* ctx)
+{
+    const std::string path = writeTempFile(std::string("\x04\x03\x02\x01\xff\xff\xff\xff", 8));
+    const std::string arg = "@" + path;
+    parseTokens({ "-n", arg.c_str(), "-s", arg.c_str() });
+
+    const ap::FileArray<int32_t> numbers = PARSE_FILE("-n FILE", ap::FileArray<int32_t>(), "numbers.");
+    const ap::FileArray<int16_t> shorts = PARSE_FILE("-s FILE", ap::FileArray<int16_t>(), "shorts.");
+    unlink(path.c_str());
+
+    if (TAP_CHECK(ctx, numbers.size() != 2 || numbers[0] != 0x01020304 || numbers[1] != -1))
+        return TAP_FAIL(ctx, "The elements have to be read as little endian.");
+    if (TAP_CHECK(ctx, shorts.size() != 4 || shorts[0] != 0x0304 || shorts[1] != 0x0102))
+        return TAP_FAIL(ctx, "The elements of any size have to be read.");
+    if (TAP_CHECK(ctx, ERROR_COUNT()))
+        return TAP_FAIL(ctx, "A binary file has no wrong elements.");
+
+    return TAP_PASS(ctx, "PARSE_FILE maps binary files.");
+}
+
+TestContext::Return testWrongFile(TestContext* ctx)
+{
+    const std::string path = writeTempFile("12345");
+    const std::string arg = "@" + path;
+    parseTokens({ "-n", arg.c_str(), "-m", "@/nonexistent/ap-test" });
+
+    const ap::FileArray<int32_t> wrongSize = PARSE_FILE("-n FILE", ap::FileArray<int32_t>(), "numbers.");
+    const ap::FileArray<int32_t> missing = PARSE_FILE("-m FILE", ap::FileArray<int32_t>(ap::FileFormat::Text), "numbers.");
+    unlink(path.c_str());
+
+    if (TAP_CHECK(ctx, !wrongSize.empty() || !missing.empty() || ERROR_COUNT() != 2))
+        return TAP_FAIL(ctx, "An unreadable file has to return the default and be an error.");
+    TAP_CHECK_ERROR(ctx, 0, "Cannot read file '" + path + "' of flag '-n'.");
+    TAP_CHECK_ERROR(ctx, 1, "Cannot read file '/nonexistent/ap-test' of flag '-m'.");
+
+    return TAP_PASS(ctx, "Unreadable files are errors.");
+}
+
+} // namespace anonymous
+
+void parserFileTests(TestContext* ctx)
+{
+    ctx->add(testFileList);
+    ctx->add(testTextFile);
+    ctx->add(testBinaryFile);
+    ctx->add(testWrongFile);
+}
+
+} // namespace testargparse
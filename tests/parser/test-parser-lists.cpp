@@ -0,0 +1,188 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test-parser.hpp"
+
+namespace testargparse {
+namespace {
+
+TestContext::Return testRepeatModes(TestContext* ctx)
+{
+    const ap::Repeat repeat = ap::s_repeat;
+    int values[3];
+    size_t unparsed[3];
+    const ap::Repeat modes[3] = { ap::Repeat::Once, ap::Repeat::First, ap::Repeat::Last };
+    for (size_t i = 0; i < 3; ++i) {
+        ap::s_repeat = modes[i];
+        parseTokens({ "-v", "1", "-v", "2", "-v", "3" });
+        values[i] = PARSE_FLAG("-v N", 0, "value.");
+        unparsed[i] = UNPARSED_COUNT();
+    }
+    ap::s_repeat = repeat;
+
+    if (TAP_CHECK(ctx, values[0] != 1 || unparsed[0] != 4))
+        return TAP_FAIL(ctx, "Repeat::Once has to leave the later occurrences for the arguments.");
+    if (TAP_CHECK(ctx, values[1] != 1 || unparsed[1]))
+        return TAP_FAIL(ctx, "Repeat::First has to parse every occurrence and keep the first value.");
+    if (TAP_CHECK(ctx, values[2] != 3 || unparsed[2]))
+        return TAP_FAIL(ctx, "Repeat::Last has to parse every occurrence and keep the last value.");
+
+    return TAP_PASS(ctx, "Repeated flags follow ap::s_repeat.");
+}
+
+TestContext::Return testLists(TestContext* ctx)
+{
+    parseTokens({ "-I", "a", "-n", "1", "-I", "b", "-n", "x", "-n", "3", "arg" });
+
+    const std::vector<std::string> dirs = PARSE_LIST("-I DIR", std::vector<std::string>(), "dirs.");
+    const std::vector<int> none = PARSE_LIST("-J N", std::vector<int>(1, 9), "none.");
+    const std::vector<int> numbers = PARSE_LIST("-n N", std::vector<int>(), "numbers.");
+
+    if (TAP_CHECK(ctx, dirs != std::vector<std::string>({ "a", "b" })))
+        return TAP_FAIL(ctx, "PARSE_LIST has to return the values in order.");
+    if (TAP_CHECK(ctx, none != std::vector<int>(1, 9)))
+        return TAP_FAIL(ctx, "An unset list has to return its default.");
+    if (TAP_CHECK(ctx, numbers != std::vector<int>({ 1, 3 })))
+        return TAP_FAIL(ctx, "A wrong value has to be skipped.");
+    if (TAP_CHECK(ctx, ERROR_COUNT() != 1 || UNPARSED_COUNT() != 1))
+        return TAP_FAIL(ctx, "A wrong value has to be an error.");
+    TAP_CHECK_ERROR(ctx, 0, "Wrong value 'x' of flag '-n'.");
+
+    return TAP_PASS(ctx, "List flags parse every occurrence.");
+}
+
+TestContext::Return testMapDuplicates(TestContext* ctx)
+{
+    const ap::Duplicate duplicate = ap::s_duplicate_key;
+    std::string values[3];
+    size_t errors[3];
+    const ap::Duplicate policies[3] = { ap::Duplicate::Last, ap::Duplicate::First, ap::Duplicate::Reject };
+    for (size_t i = 0; i < 3; ++i) {
+        ap::s_duplicate_key = policies[i];
+        parseTokens({ "-D", "A=1", "-D", "B", "-D", "A=3" });
+        const ap::FlagMap map = PARSE_MAP("-D KEY=VALUE", "defines.");
+        values[i] = std::string(map.find("A", "")) + map.find("B", "-") + std::to_string(map.size());
+        errors[i] = ERROR_COUNT();
+    }
+    ap::s_duplicate_key = duplicate;
+
+    if (TAP_CHECK(ctx, values[0] != "32" || errors[0]))
+        return TAP_FAIL(ctx, "Duplicate::Last has to keep the last value.");
+    if (TAP_CHECK(ctx, values[1] != "12" || errors[1]))
+        return TAP_FAIL(ctx, "Duplicate::First has to keep the first value.");
+    if (TAP_CHECK(ctx, values[2] != "12" || errors[2] != 1))
+        return TAP_FAIL(ctx, "Duplicate::Reject has to keep the first value and record the later ones.");
+    TAP_CHECK_ERROR(ctx, 0, "Duplicate key 'A' of flag '-D'.");
+
+    return TAP_PASS(ctx, "Duplicate keys follow ap::s_duplicate_key.");
+}
+
+TestContext::Return testSplit(TestContext* ctx)
+{
+    parseTokens({ "-L", "1,2", "-L", "x,,3", "arg" });
+
+    const std::vector<int> split = PARSE_SPLIT("-L LIST", std::vector<int>(), "numbers.");
+    const std::vector<int> none = PARSE_SPLIT("-M LIST", std::vector<int>(1, 9), "none.");
+
+    if (TAP_CHECK(ctx, split != std::vector<int>({ 1, 2, 3 })))
+        return TAP_FAIL(ctx, "PARSE_SPLIT has to return the converted parts in order.");
+    if (TAP_CHECK(ctx, none != std::vector<int>(1, 9)))
+        return TAP_FAIL(ctx, "An unset split flag has to return its default.");
+    if (TAP_CHECK(ctx, ERROR_COUNT() != 2 || UNPARSED_COUNT() != 1))
+        return TAP_FAIL(ctx, "The wrong and the empty parts have to be errors.");
+    TAP_CHECK_ERROR(ctx, 0, "Wrong value 'x,,3' of flag '-L'.");
+
+    return TAP_PASS(ctx, "PARSE_SPLIT converts every part.");
+}
+
+TestContext::Return testMatchBytes(TestContext* ctx)
+{
+    char data[64];
+    uint32_t seed = 1;
+    for (size_t size = 0; size <= 64; ++size) {
+        for (size_t i = 0; i < size; ++i) {
+            seed = seed * 1103515245 + 12345;
+            data[i] = ",a\n\x80"[(seed >> 16) & 3];
+        }
+        uint64_t expected = 0;
+        for (size_t i = 0; i < size; ++i)
+            expected |= uint64_t(',' == data[i]) << i;
+        if (TAP_CHECK(ctx, ap::matchBytes(data, size, ',') != expected))
+            return TAP_FAIL(ctx, "The bits of " + std::to_string(size) + " bytes are wrong.");
+        if (TAP_CHECK(ctx, ap::countParts(data, size, ',') != ap::countBits(expected) + 1))
+            return TAP_FAIL(ctx, "The parts of " + std::to_string(size) + " bytes are wrong.");
+    }
+
+    return TAP_PASS(ctx, "matchBytes matches the scalar comparison.");
+}
+
+/* Parses the token with or without readable bytes after it and compares it
+ * to 'convertValue()'. */
+template <typename T>
+bool sameInteger(const std::string& token, const bool& limit)
+{
+    T expected = T(7);
+    const bool converted = ap::convertValue(token, expected);
+    const std::string padded = token + "99999999";
+    T result = T(7);
+    if (ap::parseInteger(padded.data(), padded.data() + token.size(), result, limit ? padded.data() + padded.size() : nullptr) != converted)
+        return false;
+    return !converted || result == expected;
+}
+
+TestContext::Return testParseInteger(TestContext* ctx)
+{
+    const char* tokenCases[] = {
+        "0", "7", "-7", "+7", " \t42", "12x", "1234567", "12345678", "123456789", "-2147483648", "2147483648",
+        "4294967295", "4294967296", "-1", "- 1", "+-1", "", " ", "x", "000000000000000000000012",
+        "9223372036854775807", "9223372036854775808", "-9223372036854775808", "-9223372036854775809",
+        "18446744073709551615", "18446744073709551616", "-18446744073709551615", "99999999999999999999",
+    };
+    bool (*const typeCases[])(const std::string&, const bool&) = {
+        &sameInteger<short>, &sameInteger<int>, &sameInteger<unsigned>, &sameInteger<long long>, &sameInteger<unsigned long long>,
+    };
+    const bool limitCases[] = { false, true };
+
+    size_t tokenCase, typeCase, limitCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(tokenCase, tokenCases), TAP_CASES(typeCase, typeCases), TAP_CASES(limitCase, limitCases)) {
+        if (TAP_CHECK(ctx, !typeCases[typeCase](tokenCases[tokenCase], limitCases[limitCase])))
+            return TAP_FAIL(ctx, std::string("parseInteger differs from convertValue: '") + tokenCases[tokenCase] + "'.");
+    }
+
+    return TAP_PASS(ctx, "parseInteger converts like convertValue.");
+}
+
+} // namespace anonymous
+
+void parserListsTests(TestContext* ctx)
+{
+    ctx->add(testRepeatModes);
+    ctx->add(testLists);
+    ctx->add(testMapDuplicates);
+    ctx->add(testSplit);
+    ctx->add(testMatchBytes);
+    ctx->add(testParseInteger);
+}
+
+} // namespace testargparse
@@ -0,0 +1,119 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test-parser.hpp"
+#include "arg-parser-reload.h"
+
+#include <cstdio>
+
+namespace testargparse {
+namespace {
+
+struct Config {
+    int jobs = 1;
+    std::string out = "a.out";
+    bool verbose = false;
+};
+
+const ap::Field<Config> s_fields[] = {
+    BIND_FLAG(Config, jobs, "-j, --jobs N", "jobs."),
+    BIND_FLAG(Config, out, "-o, --out PATH", "output."),
+    BIND_FLAG(Config, verbose, "-v, --verbose", "verbose."),
+};
+
+bool writeFile(const std::string& path, const std::string& text)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return !std::fclose(file) && written;
+}
+
+TestContext::Return testReloaderEpochs(TestContext* ctx)
+{
+    parseTokens({ "--out", "b.out" });
+    Config config;
+    PARSE_STRUCT(s_fields, config);
+
+    const std::string path = writeTempFile("# config\n--jobs 4\n-o c.out\n--bogus 1\n");
+    ap::Reloader<Config> reloader(s_fields, config, path);
+    ap::Reloader<Config>::Reader reader(reloader);
+
+    const Config first = reader.read();
+    const std::vector<std::string> errors = reloader.errors();
+    const uint64_t epoch = reloader.epoch();
+    const bool unchanged = reloader.reload();
+    const bool changed = writeFile(path, "-j=5\n") && reloader.reload();
+    const Config second = reader.read();
+    const bool removed = writeFile(path, "") && reloader.reload();
+    const Config third = reader.read();
+    unlink(path.c_str());
+
+    if (TAP_CHECK(ctx, first.jobs != 4 || first.out != "b.out" || epoch != 1))
+        return TAP_FAIL(ctx, "The file has to be applied on top of the command line.");
+    if (TAP_CHECK(ctx, errors.size() != 1 || errors[0] != path + ":4: Unknown flag '--bogus'."))
+        return TAP_FAIL(ctx, "An unknown flag of the file has to be an error.");
+    if (TAP_CHECK(ctx, unchanged || !changed || second.jobs != 5))
+        return TAP_FAIL(ctx, "A reload has to publish the changed values only.");
+    if (TAP_CHECK(ctx, !removed || third.jobs != 1 || third.out != "b.out" || reloader.epoch() != 3))
+        return TAP_FAIL(ctx, "A removed line has to restore the value of the command line.");
+
+    return TAP_PASS(ctx, "The reloader publishes a new epoch per change.");
+}
+
+TestContext::Return testReloadBoolFlags(TestContext* ctx)
+{
+    parseTokens({});
+    Config config;
+    PARSE_STRUCT(s_fields, config);
+
+    const std::string path = writeTempFile("--verbose\n");
+    ap::Reloader<Config> reloader(s_fields, config, path);
+    ap::Reloader<Config>::Reader reader(reloader);
+
+    const bool first = reader.read().verbose;
+    const bool changed = writeFile(path, "--verbose on\n") && reloader.reload();
+    const bool second = reader.read().verbose;
+    const bool again = writeFile(path, "-v\n-j 2\n") && reloader.reload();
+    const Config third = reader.read();
+    unlink(path.c_str());
+
+    if (TAP_CHECK(ctx, !first))
+        return TAP_FAIL(ctx, "A bool flag of the file has to toggle the command line.");
+    if (TAP_CHECK(ctx, !changed || !second || !again || !third.verbose || third.jobs != 2))
+        return TAP_FAIL(ctx, "A bool flag read again has to keep its value.");
+
+    return TAP_PASS(ctx, "Bool flags of the file toggle the command line.");
+}
+
+} // namespace anonymous
+
+void parserReloadTests(TestContext* ctx)
+{
+    ctx->add(testReloaderEpochs);
+    ctx->add(testReloadBoolFlags);
+}
+
+} // namespace testargparse
@@ -0,0 +1,101 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test-parser.hpp"
+#include "arg-parser-reload.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace testargparse {
+namespace {
+
+bool isCacheAligned(const void* ptr) { return !(reinterpret_cast<uintptr_t>(ptr) & 63); }
+
+TestContext::Return testFreezeFlags(TestContext* ctx)
+{
+    parseTokens({ "--jobs", "8" });
+
+    const auto options = FREEZE_FLAGS(DEF_FLAG("-j, --jobs N", 4, "jobs."), DEF_FLAG("-o, --out PATH", std::string("a.out"), "output."));
+    parseTokens({ "--out", "b.out" });
+    const int jobs = PARSE_FLAG("-j, --jobs N", 2, "jobs.");
+
+    if (TAP_CHECK(ctx, options.get<0>() != 8 || options.get<1>() != "a.out"))
+        return TAP_FAIL(ctx, "The snapshot has to keep the values over a new parse.");
+    if (TAP_CHECK(ctx, !options.isSet<0>() || options.isSet<1>()))
+        return TAP_FAIL(ctx, "The snapshot has to keep which flags are set.");
+    if (TAP_CHECK(ctx, jobs != 2))
+        return TAP_FAIL(ctx, "The parser has to be reusable after a snapshot.");
+
+    return TAP_PASS(ctx, "Snapshots do not refer to the parser state.");
+}
+
+struct Small {
+    char c = 'c';
+};
+
+TestContext::Return testAlignedAllocations(TestContext* ctx)
+{
+    parseTokens({ "-c", "x" });
+
+    typedef ap::Snapshot<char> Options;
+    const ap::Flag<char> flag = DEF_FLAG("-c C", 'c', "a char.");
+    std::vector<std::unique_ptr<Options>> snapshots;
+    for (size_t i = 0; i < 16; ++i) {
+        snapshots.emplace_back(new Options(flag));
+        if (TAP_CHECK(ctx, !isCacheAligned(snapshots.back().get()) || snapshots.back()->get<0>() != 'x'))
+            return TAP_FAIL(ctx, "A snapshot allocated by new has to be aligned to a cache line.");
+    }
+
+    static const ap::Field<Small> fields[] = { BIND_FLAG(Small, c, "-c C", "a char.") };
+    parseTokens({});
+    Small small;
+    PARSE_STRUCT(fields, small);
+    const std::string path = writeTempFile("-c y\n");
+    ap::Reloader<Small> reloader(fields, small, path);
+    std::vector<std::unique_ptr<ap::Reloader<Small>::Reader>> readers;
+    for (size_t i = 0; i < 16; ++i) {
+        readers.emplace_back(new ap::Reloader<Small>::Reader(reloader));
+        if (TAP_CHECK(ctx, !isCacheAligned(readers.back().get()) || !isCacheAligned(&readers.back()->read())))
+            return TAP_FAIL(ctx, "The readers and snapshots of a reloader have to be aligned to a cache line.");
+    }
+    const char c = readers.back()->read().c;
+    readers.clear();
+    unlink(path.c_str());
+
+    if (TAP_CHECK(ctx, c != 'y'))
+        return TAP_FAIL(ctx, "The aligned snapshot has to keep the value of the file.");
+
+    return TAP_PASS(ctx, "Snapshots and readers are aligned to a cache line.");
+}
+
+} // namespace anonymous
+
+void parserSnapshotTests(TestContext* ctx)
+{
+    ctx->add(testFreezeFlags);
+    ctx->add(testAlignedAllocations);
+}
+
+} // namespace testargparse
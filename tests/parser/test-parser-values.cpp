@@ -0,0 +1,179 @@
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test-parser.hpp"
+
+namespace testargparse {
+namespace {
+
+TestContext::Return testRepeatedDefinitions(TestContext* ctx)
+{
+    parseTokens({ "-I", "a", "-I", "b", "-I", "c", "arg" });
+
+    const std::string a = PARSE_FLAG("-I DIR", std::string("d1"), "include dir.");
+    const std::string b = PARSE_FLAG("-I DIR", std::string("d2"), "include dir.");
+    const std::string c = PARSE_FLAG("-I DIR", std::string("d3"), "include dir.");
+    const std::string d = PARSE_FLAG("-I DIR", std::string("d4"), "include dir.");
+
+    if (TAP_CHECK(ctx, a != "a" || b != "b" || c != "c"))
+        return TAP_FAIL(ctx, "The definitions of the same spec have to take the occurrences in order.");
+    if (TAP_CHECK(ctx, d != "d4"))
+        return TAP_FAIL(ctx, "A definition without occurrence has to return its own default.");
+    if (TAP_CHECK(ctx, UNPARSED_COUNT() != 1 || PARSE_ARG(std::string()) != "arg"))
+        return TAP_FAIL(ctx, "The occurrences of the flag have to be parsed.");
+    if (TAP_CHECK(ctx, READ_FLAG("-I DIR", std::string()) != "d4"))
+        return TAP_FAIL(ctx, "READ_FLAG has to read the last definition.");
+
+    return TAP_PASS(ctx, "Repeated definitions take the next occurrence.");
+}
+
+TestContext::Return testCachedValues(TestContext* ctx)
+{
+    parseTokens({ "-n", "42", "-w", "x" });
+
+    const int n = PARSE_FLAG("-n N", 1, "a number.");
+    const int w = PARSE_FLAG("-w N", 2, "a wrong number.");
+
+    if (TAP_CHECK(ctx, n != 42 || READ_FLAG("-n N", 0) != 42))
+        return TAP_FAIL(ctx, "The value has to be converted and cached.");
+    if (TAP_CHECK(ctx, READ_FLAG("-n N", std::string()) != "42" || READ_FLAG("-n N", 0.0) != 42.0))
+        return TAP_FAIL(ctx, "The value has to be converted once per type.");
+    if (TAP_CHECK(ctx, w != 2 || READ_FLAG("-w N", 3) != 2))
+        return TAP_FAIL(ctx, "A wrong value has to keep the default of the definition.");
+    if (TAP_CHECK(ctx, ERROR_COUNT() != 1))
+        return TAP_FAIL(ctx, "A wrong value has to be recorded once.");
+    TAP_CHECK_ERROR(ctx, 0, "Wrong value 'x' of flag '-w'.");
+
+    parseTokens({ "-n", "7" });
+    if (TAP_CHECK(ctx, PARSE_FLAG("-n N", 1, "a number.") != 7))
+        return TAP_FAIL(ctx, "The cache has to be dropped by PARSE_HELP.");
+
+    return TAP_PASS(ctx, "Values are converted lazily and cached.");
+}
+
+TestContext::Return testConversions(TestContext* ctx)
+{
+    parseTokens({ "-u", "-1", "-f", " 2.5x", "-c", " z", "-b", "-l", "9223372036854775808", "-e", "1e" });
+
+    const unsigned u = PARSE_FLAG("-u N", 0u, "unsigned.");
+    const float f = PARSE_FLAG("-f F", 0.0f, "float.");
+    const char c = PARSE_FLAG("-c C", 'c', "char.");
+    const bool b = PARSE_FLAG("-b", false, "bool.");
+    const bool nb = PARSE_FLAG("-nb", true, "bool not given.");
+    const long long l = PARSE_FLAG("-l N", 5ll, "long long.");
+    const double e = PARSE_FLAG("-e F", 6.0, "double.");
+
+    if (TAP_CHECK(ctx, u != static_cast<unsigned>(-1)))
+        return TAP_FAIL(ctx, "A negative unsigned has to wrap around.");
+    if (TAP_CHECK(ctx, f != 2.5f || c != 'z'))
+        return TAP_FAIL(ctx, "The leading spaces have to be skipped and the number ends at its first invalid character.");
+    if (TAP_CHECK(ctx, !b || !nb))
+        return TAP_FAIL(ctx, "A bool flag has to toggle its default.");
+    if (TAP_CHECK(ctx, l != 5 || e != 6.0 || ERROR_COUNT() != 2))
+        return TAP_FAIL(ctx, "An overflow and an incomplete exponent have to fail.");
+
+    return TAP_PASS(ctx, "Values are converted like the stream extraction.");
+}
+
+TestContext::Return testLazyHandles(TestContext* ctx)
+{
+    parseTokens({ "-n", "x", "-m", "5" });
+
+    const ap::Flag<int> n = DEF_FLAG("-n N", 1, "a wrong number.");
+    const ap::Flag<int> m = DEF_FLAG("-m N", 2, "a number.");
+
+    if (TAP_CHECK(ctx, ERROR_COUNT() != 0))
+        return TAP_FAIL(ctx, "DEF_FLAG must not convert the value.");
+    if (TAP_CHECK(ctx, n.read() != 1 || n.read() != 1 || ERROR_COUNT() != 1))
+        return TAP_FAIL(ctx, "The first read has to convert the value and record its error once.");
+    TAP_CHECK_ERROR(ctx, 0, "Wrong value 'x' of flag '-n'.");
+    if (TAP_CHECK(ctx, !m.isSet() || m.read() != 5))
+        return TAP_FAIL(ctx, "A set flag has to read its value.");
+
+    parseTokens({ "-m", "6" });
+    if (TAP_CHECK(ctx, m.isSet() || m.read() != 2))
+        return TAP_FAIL(ctx, "A handle of the previous PARSE_HELP has to read its default.");
+    if (TAP_CHECK(ctx, DEF_FLAG("-m N", 2, "a number.").read() != 6))
+        return TAP_FAIL(ctx, "A new handle has to read the new value.");
+
+    return TAP_PASS(ctx, "Flag handles convert the value on the first read.");
+}
+
+TestContext::Return testFlagHandles(TestContext* ctx)
+{
+    parseTokens({ "--jobs", "8" });
+
+    ap::Flag<int> jobs = DEF_FLAG("-j, --jobs N", 4, "jobs.");
+    ap::Flag<std::string> out = DEF_FLAG("-o, --out PATH", std::string("a.out"), "output.");
+
+    if (TAP_CHECK(ctx, !jobs.isSet() || jobs.read() != 8))
+        return TAP_FAIL(ctx, "A set flag has to read its value.");
+    if (TAP_CHECK(ctx, out.isSet() || out.read() != "a.out"))
+        return TAP_FAIL(ctx, "An unset flag has to read its default.");
+    if (TAP_CHECK(ctx, GET_FLAG("-j", 0).read() != 8 || GET_FLAG("-o", std::string()).read() != "a.out"))
+        return TAP_FAIL(ctx, "GET_FLAG has to find the flag by any alias.");
+
+    const ap::Flag<int> pu = GET_FLAG("--pu", 1);
+    const ap::Flag<int> px = GET_FLAG("--px", 2);
+    if (TAP_CHECK(ctx, pu.isSet() || pu.read() != 1 || px.read() != 2))
+        return TAP_FAIL(ctx, "The handles of unknown flags have to keep their own defaults.");
+
+    return TAP_PASS(ctx, "Flag handles read the cached values.");
+}
+
+TestContext::Return testFindFlags(TestContext* ctx)
+{
+    parseTokens({ "--f999", "9", "-a", "1" });
+
+    for (size_t i = 0; i < 1000; ++i) {
+        const std::string spec = "--f" + std::to_string(i) + " N";
+        PARSE_FLAG(spec.c_str(), 0, "a flag.");
+    }
+    for (size_t i = 0; i < 1000; ++i)
+        if (TAP_CHECK(ctx, GET_FLAG("--f" + std::to_string(i), 0).index != i + 1))
+            return TAP_FAIL(ctx, "GET_FLAG has to find every flag.");
+    if (TAP_CHECK(ctx, GET_FLAG("--f999", 0).read() != 9))
+        return TAP_FAIL(ctx, "GET_FLAG has to read the value of the flag.");
+
+    PARSE_FLAG("-a, --all N", 2, "all.");
+    PARSE_FLAG("-a, --any N", 3, "any.");
+    if (TAP_CHECK(ctx, GET_FLAG("-a", 0).read() != 3 || GET_FLAG("--all", 0).read() != 1))
+        return TAP_FAIL(ctx, "An alias defined again has to find its last flag.");
+
+    return TAP_PASS(ctx, "GET_FLAG finds the flags by their aliases.");
+}
+
+} // namespace anonymous
+
+void parserValuesTests(TestContext* ctx)
+{
+    ctx->add(testRepeatedDefinitions);
+    ctx->add(testCachedValues);
+    ctx->add(testConversions);
+    ctx->add(testLazyHandles);
+    ctx->add(testFlagHandles);
+    ctx->add(testFindFlags);
+}
+
+} // namespace testargparse
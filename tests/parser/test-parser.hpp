@@ -0,0 +1,69 @@
+#ifndef TEST_PARSER_HPP
+#define TEST_PARSER_HPP
+
+/* Copyright (C) 2018, Szilard Ledan <szledan@gmail.com>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test.hpp"
+
+#include "arg-parser.h"
+#include "test-defs.hpp"
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace testargparse {
+
+void parserBenchTests(TestContext*);
+void parserConstraintsTests(TestContext*);
+void parserFileTests(TestContext*);
+void parserListsTests(TestContext*);
+void parserReloadTests(TestContext*);
+void parserSnapshotTests(TestContext*);
+void parserValuesTests(TestContext*);
+
+/* Resets the parser and parses the help flag of the tokens, which follow the
+ * program name. */
+inline bool parseTokens(std::initializer_list<const char*> tokens)
+{
+    std::vector<const char*> argv(1, "test");
+    argv.insert(argv.end(), tokens.begin(), tokens.end());
+    ap::reset();
+    return PARSE_HELP("-h, --help", "show this help.", "Usage: %p", static_cast<int>(argv.size()), argv.data());
+}
+
+/* Writes the bytes into a new temporary file and returns its path. */
+std::string writeTempFile(const std::string& bytes);
+
+#ifdef TAP_CHECK_ERROR
+#undef TAP_CHECK_ERROR
+#endif // TAP_CHECK_ERROR
+#define TAP_CHECK_ERROR(CTX, I, MSG) do { \
+        if (TAP_CHECK(CTX, ERROR_COUNT() <= I || ERROR_MSG(I) != MSG)) \
+            return TAP_FAIL(CTX, std::string("The error ") + std::to_string(I) + " is not: " + MSG); \
+    } while (false)
+
+} // namespace testargparse
+
+#endif // TEST_PARSER_HPP
@@ -53,7 +53,22 @@
 #ifdef TAP_CHECK
 #undef TAP_CHECK
 #endif // TAP_CHECK
-#define TAP_CHECK(CTX, COND) CTX->check((COND))
+#define TAP_CHECK(CTX, COND) CTX->check((COND), __LINE__)
+
+#ifdef TAP_BENCH
+#undef TAP_BENCH
+#endif // TAP_BENCH
+#define TAP_BENCH(CTX, NAME, ITERATIONS, ...) CTX->bench(NAME, ITERATIONS, [&]() { __VA_ARGS__; }, TAP_FILE_FUNC_LINE)
+
+#ifdef TAP_CASES
+#undef TAP_CASES
+#endif // TAP_CASES
+#define TAP_CASES(INDEX, TEST_CASES) { &INDEX, TAP_ARRAY_SIZE(TEST_CASES) }
+
+#ifdef TAP_FOR_CASES
+#undef TAP_FOR_CASES
+#endif // TAP_FOR_CASES
+#define TAP_FOR_CASES(CTX, ...) for (testargparse::Combinations tapCombinations(CTX->param.coverage, { __VA_ARGS__ }, CTX->param.shard, CTX->param.shards); tapCombinations.next(); )
 
 #ifdef TAP_CHARS
 #undef TAP_CHARS
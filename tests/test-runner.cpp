@@ -24,7 +24,7 @@
 
 #include "test.hpp"
 
-#include "arg-parse.hpp"
+#include "arg-parser.h"
 #include <iostream>
 
 // Configure and run tests.
@@ -32,63 +32,89 @@
 int main(int argc, char* argv[])
 {
     struct {
-        const bool nonSpecified() const { return !api && !unit && ! manual; }
+        const bool nonSpecified() const { return !api && !unit && !manual && !parser && !harness; }
+        bool help = false;
         bool all = false;
         bool api = false;
         bool silent = false;
         bool unit = false;
         bool manual = false;
-        std::string manualValue = "";
+        bool parser = false;
+        bool harness = false;
+        std::string manualValue = "program.name=show-help"
+                                  ",mode.strict=true"
+                                  ",help.add=true"
+                                  ",help.tab=\t"
+                                  ",help.compact=on"
+                                  ",help.margin=26"
+                                  ",help.show=2";
+        size_t jobs = 1;
+        size_t slowest = 5;
+        std::string baseline = "";
+        double threshold = 10.0;
+        bool updateBaseline = false;
+        bool tap = false;
+        bool pairwise = false;
+        size_t shard = 0;
+        size_t shards = 1;
+        std::string junit = "";
     } options;
 
     // Parse arguments.
     {
-        using namespace argparse;
-        ArgParse args;
-
-        // Define options.
-        args.def(Flag("--api", "-a", "Select api tests."));
-        Value helpTestConfigs = Value("program.name=show-help"
-                                      ",mode.strict=true"
-                                      ",help.add=true"
-                                      ",help.tab=\t"
-                                      ",help.compact=on"
-                                      ",help.margin=26"
-                                      ",help.show=2" /*< Default value. */,
-                                      !Value::Required, /*< Set non required. */
-                                      "options" /*< Name of value. */,
-                                      "This value is interlaced, see more: ArgParse Api Reference." /*< Description of value. */);
-        args.def(Flag("--manual", "-m", "Select manual tests.", helpTestConfigs));
-        args.def(Flag("--unit", "-u", "Select unit tests."));
-        args.def(Flag("--silent", "-s", "Fails show only."));
-
-        // Parse argv and argc and check errors.
-        if (!args.parse(argc, argv)) {
-            std::cout << args.error() << std::endl;
-            std::cout << args.help() << std::endl;
-            return 1;
-        }
+        options.help = PARSE_HELP("-h, --help", "show this help.", "Usage: %p [options]\n\nOptions:", argc, argv);
+        options.all = PARSE_FLAG("--all", false, "select all tests.");
+        options.api = PARSE_FLAG("-a, --api", false, "select api tests.");
+        options.manual = PARSE_FLAG("-m, --manual", false, "select manual tests.");
+        options.manualValue = PARSE_FLAG("--manual-options OPTIONS", options.manualValue, "options of the manual tests, see more: ArgParse Api Reference.");
+        options.unit = PARSE_FLAG("-u, --unit", false, "select unit tests.");
+        options.parser = PARSE_FLAG("-p, --parser", false, "select arg-parser.h tests.");
+        options.harness = PARSE_FLAG("--harness", false, "select tests of the test harness.");
+        options.silent = PARSE_FLAG("-s, --silent", false, "fails show only.");
+        options.jobs = PARSE_FLAG("-j, --jobs N", options.jobs, "run tests in parallel processes.");
+        options.slowest = PARSE_FLAG("--slowest N", options.slowest, "report the N slowest tests and checks.");
+        options.baseline = PARSE_FLAG("--baseline FILE", options.baseline, "compare benchmarks with the ns/op values of a file.");
+        options.threshold = PARSE_FLAG("--threshold PERCENT", options.threshold, "allowed benchmark regression in percent.");
+        options.updateBaseline = PARSE_FLAG("--update-baseline", false, "write the benchmark results to the baseline file.");
+        options.tap = PARSE_FLAG("--tap", false, "write the results in TAP format.");
+        options.pairwise = PARSE_FLAG("--pairwise", false, "cover only the value pairs of the test case matrices.");
+        options.shard = PARSE_FLAG("--shard I", options.shard, "run only the I-th shard of the test case matrices.");
+        options.shards = PARSE_FLAG("--shards N", options.shards, "divide the test case matrices into N shards.");
+        options.junit = PARSE_FLAG("--junit FILE", options.junit, "write the results to a JUnit XML file too.");
 
         // Check help flags.
-        if (args["--help"].isSet) {
-            std::cout << args.help() << std::endl;
+        if (options.help)
             return 0;
-        }
 
-        // Collect options.
-        options.all = args["--all"].isSet;
-        options.api = args["--api"].isSet;
-        options.silent = args["--silent"].isSet;
-        options.unit = args["--unit"].isSet;
-        if ((options.manual = args["--manual"].isSet))
-            options.manualValue = args["--manual"].value.str;
+        // Check errors.
+        if (ERROR_COUNT() || UNPARSED_COUNT()) {
+            for (size_t i = 0; i < ERROR_COUNT(); ++i)
+                std::cout << ERROR_MSG(i) << std::endl;
+            if (UNPARSED_COUNT())
+                std::cout << "Unknown argument: " << PARSE_ARG(std::string()) << std::endl;
+            return 1;
+        }
+        if (!options.shards || options.shard >= options.shards) {
+            std::cout << "The shard has to be less than the number of shards." << std::endl;
+            return 1;
+        }
     }
 
     // Create test context.
-    testargparse::TestContext ctx(!options.silent);
+    testargparse::TestContext ctx(!options.silent, options.jobs);
+    ctx.param.slowest = options.slowest;
+    ctx.param.baseline = options.baseline;
+    ctx.param.threshold = options.threshold / 100.0;
+    ctx.param.updateBaseline = options.updateBaseline;
+    ctx.param.format = options.tap ? testargparse::TestContext::Tap : testargparse::TestContext::Text;
+    ctx.param.junit = options.junit;
+    ctx.param.coverage = options.pairwise ? testargparse::Combinations::Pairwise : testargparse::Combinations::Exhaustive;
+    ctx.param.shard = options.shard;
+    ctx.param.shards = options.shards;
 
     const bool all = options.all || options.nonSpecified();
 
+#if defined(TEST_ARG_PARSE_HPP)
     // Run manual tests.
     if (options.manual || all) {
         ctx.param.str = options.manualValue;
@@ -104,6 +130,23 @@ int main(int argc, char* argv[])
     if (options.unit || all) {
         testargparse::unitAndBehaviorTests(&ctx);
     }
+#else
+    // The api, manual and unit tests are built with arg-parse.hpp only.
+    if (options.manual || options.api || options.unit) {
+        std::cout << "The api, manual and unit tests are not built without arg-parse.hpp." << std::endl;
+        return 1;
+    }
+#endif // defined(TEST_ARG_PARSE_HPP)
+
+    // Collect arg-parser.h tests.
+    if (options.parser || all) {
+        testargparse::parserTests(&ctx);
+    }
+
+    // Collect tests of the test harness.
+    if (options.harness || all) {
+        testargparse::harnessTests(&ctx);
+    }
 
     // Run collected tests.
     int ret = ctx.run();
@@ -24,29 +24,271 @@
 
 #include "test.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <math.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace testargparse {
 
 // Util functions.
 namespace {
 
-#include <math.h>
-
 inline float perCent(const size_t& counter, const size_t& denom, const float& precision = 100.0f)
 {
-    return (denom * precision) ? trunc(float(counter) / float(denom) * precision * 100.0f) / precision : 0.0f;
+    return (denom && precision > 0.0f) ? trunc(float(counter) / float(denom) * precision * 100.0f) / precision : 0.0f;
+}
+
+std::string readAll(std::FILE* file)
+{
+    std::string str;
+    char buffer[4096];
+    std::rewind(file);
+    for (size_t size; (size = std::fread(buffer, 1, sizeof(buffer), file)) > 0; )
+        str.append(buffer, size);
+    return str;
+}
+
+std::string xmlEscape(const std::string& str)
+{
+    std::string escaped;
+    for (const char c : str) {
+        switch (c) {
+        case '<': escaped += "&lt;"; break;
+        case '>': escaped += "&gt;"; break;
+        case '&': escaped += "&amp;"; break;
+        case '"': escaped += "&quot;"; break;
+        default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+// The reports of the forked tests are length prefixed strings: '<size>:<bytes>'.
+void putString(std::FILE* file, const std::string& str)
+{
+    std::fprintf(file, "%zu:", str.size());
+    std::fwrite(str.data(), 1, str.size(), file);
+}
+
+bool getString(const std::string& data, size_t& pos, std::string& str)
+{
+    const size_t colon = data.find(':', pos);
+    if (colon == std::string::npos || colon == pos)
+        return false;
+    const size_t size = std::strtoull(data.c_str() + pos, nullptr, 10);
+    if (colon + 1 + size > data.size())
+        return false;
+    str = data.substr(colon + 1, size);
+    pos = colon + 1 + size;
+    return true;
+}
+
+template <typename T>
+bool getNumber(const std::string& data, size_t& pos, T& number)
+{
+    std::string str;
+    if (!getString(data, pos, str))
+        return false;
+    std::istringstream ss(str);
+    return bool(ss >> number);
 }
 
 } // namespace anonymous
 
+// Combinations
+
+Combinations::Combinations(const Coverage& coverage, std::initializer_list<Dimension> dims, const size_t& shard, const size_t& shards)
+    : _coverage(dims.size() > 2 ? coverage : Coverage::Exhaustive)
+    , _dims(dims)
+    , _values(dims.size(), 0)
+    , _shard(shard)
+    , _shards(shards ? shards : 1)
+    , _sequence(0)
+    , _count(0)
+    , _started(false)
+    , _uncoveredCount(0)
+{
+}
+
+bool Combinations::next()
+{
+    for (;;) {
+        if (!(_coverage == Coverage::Pairwise ? nextPairwise() : nextExhaustive()))
+            return false;
+        if (_sequence++ % _shards == _shard)
+            break;
+    }
+
+    for (size_t dim = 0; dim < _dims.size(); ++dim)
+        *_dims[dim].index = _values[dim];
+    ++_count;
+    return true;
+}
+
+/* The last dimension changes the fastest, like the innermost loop. */
+bool Combinations::nextExhaustive()
+{
+    for (auto& dim : _dims)
+        if (!dim.size)
+            return false;
+
+    if (!_started) {
+        _started = true;
+        return true;
+    }
+
+    for (size_t dim = _dims.size(); dim-- > 0; ) {
+        if (++_values[dim] < _dims[dim].size)
+            return true;
+        _values[dim] = 0;
+    }
+    return false;
+}
+
+/* Greedy all-pairs: a new case starts from the first uncovered pair and the
+ * other dimensions get the value which covers the most new pairs. */
+bool Combinations::nextPairwise()
+{
+    if (!_started) {
+        for (auto& dim : _dims)
+            if (!dim.size)
+                return false;
+        _started = true;
+        _uncovered.resize(_dims.size() * _dims.size());
+        for (size_t a = 0; a < _dims.size(); ++a)
+            for (size_t b = a + 1; b < _dims.size(); ++b) {
+                _uncovered[pairIndex(a, b)].assign(_dims[a].size * _dims[b].size, true);
+                _uncoveredCount += _dims[a].size * _dims[b].size;
+            }
+    }
+
+    if (!_uncoveredCount)
+        return false;
+
+    std::vector<bool> assigned(_dims.size(), false);
+    bool found = false;
+    for (size_t a = 0; a < _dims.size() && !found; ++a)
+        for (size_t b = a + 1; b < _dims.size() && !found; ++b) {
+            const std::vector<bool>& pairs = _uncovered[pairIndex(a, b)];
+            for (size_t pair = 0; pair < pairs.size() && !found; ++pair) {
+                if (!pairs[pair])
+                    continue;
+                _values[a] = pair / _dims[b].size;
+                _values[b] = pair % _dims[b].size;
+                assigned[a] = assigned[b] = true;
+                found = true;
+            }
+        }
+
+    for (size_t dim = 0; dim < _dims.size(); ++dim) {
+        if (assigned[dim])
+            continue;
+        size_t best = 0;
+        size_t bestGain = 0;
+        for (size_t value = 0; value < _dims[dim].size; ++value) {
+            size_t gain = 0;
+            for (size_t other = 0; other < _dims.size(); ++other) {
+                if (!assigned[other])
+                    continue;
+                gain += other < dim
+                    ? _uncovered[pairIndex(other, dim)][_values[other] * _dims[dim].size + value]
+                    : _uncovered[pairIndex(dim, other)][value * _dims[other].size + _values[other]];
+            }
+            if (gain > bestGain) {
+                best = value;
+                bestGain = gain;
+            }
+        }
+        _values[dim] = best;
+        assigned[dim] = true;
+    }
+
+    cover(_values);
+    return true;
+}
+
+void Combinations::cover(const std::vector<size_t>& values)
+{
+    for (size_t a = 0; a < _dims.size(); ++a)
+        for (size_t b = a + 1; b < _dims.size(); ++b) {
+            std::vector<bool>::reference pair = _uncovered[pairIndex(a, b)][values[a] * _dims[b].size + values[b]];
+            if (pair) {
+                pair = false;
+                --_uncoveredCount;
+            }
+        }
+}
+
+// Writer
+
+/* Buffers the output up to a fixed size, and it is flushed after every test,
+ * so long runs show their progress and the memory does not grow with them. */
+class TestContext::Writer {
+public:
+    Writer(std::FILE* file, const bool& owned = false)
+        : _file(file)
+        , _owned(owned)
+    {
+        _buffer.reserve(s_capacity);
+    }
+
+    ~Writer()
+    {
+        flush();
+        if (_owned)
+            std::fclose(_file);
+    }
+
+    Writer& operator<<(const std::string& str)
+    {
+        if (_buffer.size() + str.size() > s_capacity)
+            flush();
+        if (str.size() > s_capacity)
+            std::fwrite(str.data(), 1, str.size(), _file);
+        else
+            _buffer += str;
+        return *this;
+    }
+
+    template <typename T>
+    Writer& operator<<(const T& value)
+    {
+        std::ostringstream ss;
+        ss << value;
+        return *this << ss.str();
+    }
+
+    void flush()
+    {
+        std::fwrite(_buffer.data(), 1, _buffer.size(), _file);
+        std::fflush(_file);
+        _buffer.clear();
+    }
+
+private:
+    static const size_t s_capacity = 1 << 16;
+    std::FILE* _file;
+    const bool _owned;
+    std::string _buffer;
+};
+
 // TestContext
 
-TestContext::TestContext(const bool& showPass)
+TestContext::TestContext(const bool& showPass, const size_t& jobs)
     : _showPass(showPass)
+    , _jobs(jobs)
+{
+}
+
+TestContext::~TestContext()
 {
-    _result << std::endl << "ArgParse Test Suite created." << std::endl;
-    _result << std::endl << "Ready to collecting tests." << std::endl;
 }
 
 void TestContext::add(TestContext::TestInstanceFunc test)
@@ -60,53 +302,346 @@ int TestContext::run()
     size_t pass = 0;
     size_t nott = 0;
 
+    readBaseline();
+
     if (nums) {
-        _result << std::endl << "Run " << nums << " collected test(s)!" << std::endl;
-        if (!_showPass)
-            _result << "Passes does not show." << std::endl;
-        _result << std::endl;
+        _out.reset(new Writer(stderr));
+        if (!param.junit.empty()) {
+            std::FILE* junit = std::fopen(param.junit.c_str(), "w");
+            if (junit)
+                _junit.reset(new Writer(junit, true));
+            else
+                *_out << "Cannot open the JUnit report: " << param.junit << "\n";
+        }
+
+        emitBegin(nums);
 
-        for (auto test : _tests) {
-            switch (test(this)) {
+        if (_jobs > 1) {
+            runParallel();
+        } else {
+            for (auto test : _tests) {
+                runTest(test, _records.size());
+                emit(_current);
+            }
+        }
+
+        for (auto& record : _records) {
+            switch (record.ret) {
             case Return::Pass: pass++; break;
             case Return::NotTested: nott++; break;
             default: break;
             }
         }
 
+        emitEnd(pass, nott, nums);
+
+        _junit.reset();
+        _out.reset();
+    }
+
+    return pass == nums ? 0 : 1;
+}
+
+TestContext::Return TestContext::runTest(TestInstanceFunc test, const size_t& index)
+{
+    _current = Record();
+    const Clock::time_point start = Clock::now();
+    _checkStart = start;
+    _current.ret = test(this);
+    _current.ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    if (_current.name.empty())
+        _current.name = "#" + std::to_string(index);
+    return _current.ret;
+}
+
+/* Every test runs in a forked process, so the global state of the parser is
+ * isolated. The record of the test and its standard outputs go to temporary
+ * files, which are read back and closed when the test ends, so only the
+ * running tests hold files. The results are emitted in the order of the
+ * tests as soon as possible. */
+void TestContext::runParallel()
+{
+    const std::vector<TestInstanceFunc> tests(_tests.begin(), _tests.end());
+    struct Worker {
+        std::FILE* report;
+        std::FILE* output;
+        bool done;
+        Record record;
+        std::string text;
+    };
+    std::vector<Worker> workers(tests.size(), { nullptr, nullptr, false, Record(), std::string() });
+    std::map<pid_t, size_t> running;
+    size_t next = 0;
+    size_t emitted = 0;
+
+    auto close = [](Worker& worker) {
+        if (worker.output) {
+            worker.text = readAll(worker.output);
+            std::fclose(worker.output);
+            worker.output = nullptr;
+        }
+        if (worker.report) {
+            std::fclose(worker.report);
+            worker.report = nullptr;
+        }
+    };
+
+    auto failed = [&close](Worker& worker, const std::string& msg, const size_t& index) {
+        close(worker);
+        worker.record = Record();
+        worker.record.ret = Return::Fail;
+        worker.record.name = "#" + std::to_string(index);
+        worker.record.messages.push_back({ Return::Fail, msg, "", "", "" });
+        worker.done = true;
+    };
+
+    while (emitted < tests.size()) {
+        while (next < tests.size() && running.size() < _jobs) {
+            Worker& worker = workers[next];
+            worker.report = std::tmpfile();
+            worker.output = std::tmpfile();
+            std::cout.flush();
+            std::fflush(nullptr);
+
+            const pid_t pid = worker.report && worker.output ? fork() : -1;
+            if (!pid) {
+                dup2(fileno(worker.output), STDOUT_FILENO);
+                dup2(fileno(worker.output), STDERR_FILENO);
+                _checks = { 0, 0 };
+                runTest(tests[next], next);
+                std::cout.flush();
+                std::clog.flush();
+                std::FILE* report = worker.report;
+                putString(report, std::to_string(_checks.pass));
+                putString(report, std::to_string(_checks.fail));
+                putString(report, std::to_string(int(_current.ret)));
+                putString(report, _current.name);
+                putString(report, std::to_string(_current.ns));
+                putString(report, std::to_string(_current.checkNs));
+                putString(report, std::to_string(_current.checkLine));
+                putString(report, std::to_string(_current.benches.size()));
+                for (auto& bench : _current.benches) {
+                    putString(report, bench.first);
+                    putString(report, std::to_string(bench.second));
+                }
+                putString(report, std::to_string(_current.messages.size()));
+                for (auto& message : _current.messages) {
+                    putString(report, std::to_string(int(message.ret)));
+                    putString(report, message.msg);
+                    putString(report, message.file);
+                    putString(report, message.func);
+                    putString(report, message.line);
+                }
+                std::fflush(nullptr);
+                _exit(0);
+            }
+
+            if (pid < 0)
+                failed(worker, "Cannot start test #" + std::to_string(next) + ".", next);
+            else
+                running[pid] = next;
+            ++next;
+        }
+
+        while (emitted < tests.size() && workers[emitted].done) {
+            Worker& worker = workers[emitted];
+            std::cout << worker.text;
+            std::cout.flush();
+            emit(worker.record);
+            worker.record = Record();
+            worker.text = std::string();
+            ++emitted;
+        }
+
+        if (running.empty())
+            continue;
+
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0)
+            break;
+        auto it = running.find(pid);
+        if (it == running.end())
+            continue;
+
+        Worker& worker = workers[it->second];
+        Record& record = worker.record;
+        const std::string report = readAll(worker.report);
+        size_t pos = 0;
+        size_t checksPass = 0;
+        size_t checksFail = 0;
+        int ret = Return::Fail;
+        size_t benches = 0;
+        size_t messages = 0;
+        bool ok = WIFEXITED(status) && !WEXITSTATUS(status)
+            && getNumber(report, pos, checksPass) && getNumber(report, pos, checksFail)
+            && getNumber(report, pos, ret) && getString(report, pos, record.name)
+            && getNumber(report, pos, record.ns) && getNumber(report, pos, record.checkNs)
+            && getNumber(report, pos, record.checkLine) && getNumber(report, pos, benches);
+        for (size_t i = 0; ok && i < benches; ++i) {
+            std::pair<std::string, double> bench;
+            ok = getString(report, pos, bench.first) && getNumber(report, pos, bench.second);
+            record.benches.push_back(bench);
+        }
+        ok = ok && getNumber(report, pos, messages);
+        for (size_t i = 0; ok && i < messages; ++i) {
+            Message message;
+            int messageRet = Return::Fail;
+            ok = getNumber(report, pos, messageRet) && getString(report, pos, message.msg)
+                && getString(report, pos, message.file) && getString(report, pos, message.func)
+                && getString(report, pos, message.line);
+            message.ret = Return(messageRet);
+            record.messages.push_back(message);
+        }
+
+        if (ok) {
+            close(worker);
+            record.ret = Return(ret);
+            worker.done = true;
+            _checks.pass += checksPass;
+            _checks.fail += checksFail;
+        } else {
+            failed(worker, "Test #" + std::to_string(it->second) + " died"
+                + (WIFSIGNALED(status) ? " by signal " + std::to_string(WTERMSIG(status)) : std::string("")) + ".", it->second);
+        }
+        running.erase(it);
+    }
+}
+
+void TestContext::emitBegin(const size_t& nums)
+{
+    if (param.format == Format::Tap) {
+        *_out << "TAP version 13\n1.." << nums << "\n";
+    } else {
+        *_out << "\nArgParse Test Suite created.\n\nReady to collecting tests.\n";
+        *_out << "\nRun " << nums << " collected test(s)!\n";
+        if (!_showPass)
+            *_out << "Passes does not show.\n";
+        if (_jobs > 1)
+            *_out << "Run in " << _jobs << " parallel processes.\n";
+        *_out << "\n";
+    }
+
+    if (_junit)
+        *_junit << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuite name=\"ArgParse\" tests=\"" << nums << "\">\n";
+    _out->flush();
+}
+
+void TestContext::emit(Record& record)
+{
+    static const char* const s_kinds[] = { "FAIL", "PASS", "NOT TESTED" };
+    static const char* const s_colors[] = { "\033[31;1m", "\033[32;1m", "\033[33;1m" };
+    const size_t number = _records.size() + 1;
+
+    if (param.format == Format::Tap) {
+        *_out << (record.ret == Return::Fail ? "not ok " : "ok ") << number << " - " << record.name;
+        if (record.ret == Return::NotTested)
+            *_out << " # SKIP";
+        *_out << "\n";
+    }
+
+    std::string output;
+    for (auto& message : record.messages) {
+        if (message.ret == Return::Pass && !_showPass)
+            continue;
+        if (param.format == Format::Tap) {
+            *_out << "# " << s_kinds[message.ret] << ": " << message.msg << "\n";
+        } else {
+            if (!message.func.empty())
+                *_out << "The " << message.func << "() at " << message.file << ":" << message.line << "\n";
+            *_out << s_colors[message.ret] << "  " << s_kinds[message.ret] << "\033[39m\033[22m\033[49m: " << message.msg << "\n";
+        }
+        output += std::string(s_kinds[message.ret]) + ": " + message.msg + "\n";
+    }
+
+    if (_junit) {
+        const std::string file = record.messages.empty() ? std::string() : record.messages.front().file;
+        *_junit << "  <testcase classname=\"" << xmlEscape(file) << "\" name=\"" << xmlEscape(record.name) << "\" time=\"" << record.ns / 1e9 << "\">\n";
+        if (record.ret == Return::Fail)
+            *_junit << "    <failure message=\"" << xmlEscape(record.messages.empty() ? std::string() : record.messages.back().msg) << "\"/>\n";
+        else if (record.ret == Return::NotTested)
+            *_junit << "    <skipped/>\n";
+        if (!output.empty())
+            *_junit << "    <system-out>" << xmlEscape(output) << "</system-out>\n";
+        *_junit << "  </testcase>\n";
+        _junit->flush();
+    }
+    _out->flush();
+
+    record.messages.clear();
+    _records.push_back(record);
+}
+
+void TestContext::emitEnd(const size_t& pass, const size_t& nott, const size_t& nums)
+{
+    std::ostringstream ss;
+
 #define TAP_WRITE_RESULT(R, N, C) \
     R << "/" << N << " (" << perCent(R, N) << "%) where were " << C << "/" << _checks.sum() << " (" << perCent(C, _checks.sum() ? _checks.sum() : 1) << "%) checks."
 
-        _result << std::endl << "Results:" << std::endl;
-        _result << "  Pass: " << TAP_WRITE_RESULT(pass, nums, _checks.pass) << std::endl;
-        _result << "  Fail: " << TAP_WRITE_RESULT(nums - (pass + nott), nums, _checks.fail) << std::endl;
-        _result << "  Not tested: " << TAP_WRITE_RESULT(nott, nums, 0) << std::endl;
+    ss << std::endl << "Results:" << std::endl;
+    ss << "  Pass: " << TAP_WRITE_RESULT(pass, nums, _checks.pass) << std::endl;
+    ss << "  Fail: " << TAP_WRITE_RESULT(nums - (pass + nott), nums, _checks.fail) << std::endl;
+    ss << "  Not tested: " << TAP_WRITE_RESULT(nott, nums, 0) << std::endl;
 #undef TAP_WRITE_RESULT
 
-        std::clog << _result.str();
+    comment(ss.str());
+    reportSlowest();
+    if (param.updateBaseline)
+        writeBaseline();
+
+    if (_junit)
+        *_junit << "</testsuite>\n";
+    _out->flush();
+}
+
+void TestContext::comment(const std::string& text)
+{
+    if (param.format != Format::Tap) {
+        *_out << text;
+        return;
     }
 
-    return pass == nums ? 0 : 1;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line))
+        *_out << (line.empty() ? "#" : "# ") << line << "\n";
+}
+
+TestContext::Return TestContext::message(const Return& ret, const std::string& msg, const std::string& file, const std::string& func, const std::string& line)
+{
+    if (_current.name.empty())
+        _current.name = func;
+    _current.messages.push_back({ ret, msg, file, func, line });
+    return ret;
 }
 
 TestContext::Return TestContext::pass(const std::string& msg, const std::string& file, const std::string& func, const std::string& line)
 {
-    if (_showPass) {
-        this->test(file, func, line);
-        _result << "\033[32;1m" << "  PASS" << "\033[39m\033[22m\033[49m: " << msg << std::endl;
-    }
-    return Return::Pass;
+    return message(Return::Pass, msg, file, func, line);
 }
 
 TestContext::Return TestContext::fail(const std::string& msg, const std::string& file, const std::string& func, const std::string& line)
 {
-    this->test(file, func, line);
-    _result << "\033[31;1m" << "  FAIL" << "\033[39m\033[22m\033[49m: " << msg << std::endl;
-    return Return::Fail;
+    return message(Return::Fail, msg, file, func, line);
+}
+
+TestContext::Return TestContext::nott(const std::string& msg, const std::string& file, const std::string& func, const std::string& line)
+{
+    return message(Return::NotTested, msg, file, func, line);
 }
 
-const bool& TestContext::check(const bool& condition)
+/* A check takes the time from the previous check or from the start of the
+ * test, so the test body before it is measured too. */
+const bool& TestContext::check(const bool& condition, const size_t& line)
 {
+    const Clock::time_point now = Clock::now();
+    const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _checkStart).count();
+    if (ns >= _current.checkNs) {
+        _current.checkNs = ns;
+        _current.checkLine = line;
+    }
+    _checkStart = now;
     if (condition)
         _checks.fail++;
     else
@@ -114,16 +649,86 @@ const bool& TestContext::check(const bool& condition)
     return condition;
 }
 
-TestContext::Return TestContext::nott(const std::string& msg, const std::string& file, const std::string& func, const std::string& line)
+TestContext::Return TestContext::benchResult(const std::string& name, const size_t& iterations, const uint64_t& ns, const std::string& file, const std::string& func, const std::string& line)
+{
+    const double nsPerOp = double(ns) / double(iterations ? iterations : 1);
+    _current.benches.push_back({ name, nsPerOp });
+    /* The benchmark is not counted in the time of the next check. */
+    _checkStart = Clock::now();
+
+    std::ostringstream msg;
+    msg << "Benchmark " << name << ": " << nsPerOp << " ns/op in " << iterations << " iteration(s)";
+    auto it = _baseline.find(name);
+    if (it != _baseline.end() && it->second > 0) {
+        const double change = nsPerOp / it->second - 1.0;
+        msg << ", baseline: " << it->second << " ns/op (" << (change < 0 ? "" : "+") << trunc(change * 10000.0) / 100.0 << "%)";
+        if (!param.updateBaseline && change > param.threshold) {
+            msg << " is over the " << param.threshold * 100.0 << "% threshold.";
+            return fail(msg.str(), file, func, line);
+        }
+    }
+    msg << ".";
+    return pass(msg.str(), file, func, line);
+}
+
+/* The baseline file has one 'ns/op name' pair per line. */
+void TestContext::readBaseline()
+{
+    _baseline.clear();
+    if (param.baseline.empty())
+        return;
+
+    std::ifstream file(param.baseline);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream ss(line);
+        double value = 0;
+        std::string name;
+        if (ss >> value >> std::ws && std::getline(ss, name) && !name.empty())
+            _baseline[name] = value;
+    }
+}
+
+void TestContext::writeBaseline()
 {
-    this->test(file, func, line);
-    _result << "\033[33;1m" << "  NOT TESTED" << "\033[39m\033[22m\033[49m: " << msg << std::endl;
-    return Return::NotTested;
+    if (param.baseline.empty())
+        return;
+
+    std::map<std::string, double> baseline(_baseline);
+    for (auto& record : _records)
+        for (auto& bench : record.benches)
+            baseline[bench.first] = bench.second;
+
+    std::ofstream file(param.baseline);
+    file << std::setprecision(10);
+    for (auto& bench : baseline)
+        file << bench.second << " " << bench.first << std::endl;
+    comment(std::string(file ? "Baseline is updated: " : "Cannot write the baseline: ") + param.baseline + "\n");
 }
 
-inline void TestContext::test(const std::string& file, const std::string& func, const std::string& line)
+void TestContext::reportSlowest()
 {
-    _result << "The " << func  << "() at " << file << ":" << line << std::endl;
+    if (!param.slowest || _records.empty())
+        return;
+
+    const size_t nums = std::min(param.slowest, _records.size());
+    std::vector<const Record*> order;
+    for (auto& record : _records)
+        order.push_back(&record);
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+
+    std::partial_sort(order.begin(), order.begin() + nums, order.end(), [](const Record* a, const Record* b) { return a->ns > b->ns; });
+    ss << std::endl << "Slowest tests:" << std::endl;
+    for (size_t i = 0; i < nums; ++i)
+        ss << "  " << std::setw(10) << order[i]->ns / 1e6 << " ms: " << order[i]->name << "()" << std::endl;
+
+    std::partial_sort(order.begin(), order.begin() + nums, order.end(), [](const Record* a, const Record* b) { return a->checkNs > b->checkNs; });
+    ss << std::endl << "Slowest checks:" << std::endl;
+    for (size_t i = 0; i < nums && order[i]->checkLine; ++i)
+        ss << "  " << std::setw(10) << order[i]->checkNs / 1e6 << " ms: " << order[i]->name << "() at line " << order[i]->checkLine << std::endl;
+
+    comment(ss.str());
 }
 
 } // namespace testargparse
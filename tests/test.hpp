@@ -27,18 +27,62 @@
 
 #include "test-defs.hpp"
 
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <set>
+#include <vector>
 
 namespace testargparse {
 
+/* Enumerates the index combinations of test case matrices one by one. The
+ * exhaustive coverage walks the whole cartesian product, the pairwise one
+ * covers every value pair of every two dimensions with far fewer cases. The
+ * cases can be divided among shards, every shard gets every shards-th case. */
+class Combinations {
+public:
+    enum Coverage { Exhaustive, Pairwise };
+    struct Dimension {
+        size_t* index;
+        size_t size;
+    };
+
+    Combinations(const Coverage&, std::initializer_list<Dimension>, const size_t& shard = 0, const size_t& shards = 1);
+
+    bool next();
+    const size_t& count() const { return _count; }
+
+private:
+    bool nextExhaustive();
+    bool nextPairwise();
+    size_t pairIndex(const size_t& a, const size_t& b) const { return a * _dims.size() + b; }
+    void cover(const std::vector<size_t>& values);
+
+    const Coverage _coverage;
+    std::vector<Dimension> _dims;
+    std::vector<size_t> _values;
+    const size_t _shard;
+    const size_t _shards;
+    size_t _sequence;
+    size_t _count;
+    bool _started;
+    std::vector<std::vector<bool>> _uncovered;
+    size_t _uncoveredCount;
+};
+
 class TestContext {
 public:
     enum Return { Fail, Pass, NotTested };
     typedef Return (*TestInstanceFunc)(TestContext*);
 
-    TestContext(const bool& = true);
+    enum Format { Text, Tap };
+
+    TestContext(const bool& = true, const size_t& jobs = 1);
+    ~TestContext();
 
     void add(TestInstanceFunc);
     int run();
@@ -46,14 +90,65 @@ public:
     Return pass(const std::string& msg, const std::string& file, const std::string& func, const std::string& line);
     Return fail(const std::string& msg, const std::string& file, const std::string& func, const std::string& line);
     Return nott(const std::string& msg, const std::string& file, const std::string& func, const std::string& line);
-    const bool& check(const bool& condition);
+    const bool& check(const bool& condition, const size_t& line = 0);
+
+    template <typename Body>
+    Return bench(const std::string& name, const size_t& iterations, const Body& body, const std::string& file, const std::string& func, const std::string& line)
+    {
+        const Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            body();
+        const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        return benchResult(name, iterations, ns, file, func, line);
+    }
 
     struct Param {
         std::string str;
+        size_t slowest = 5;
+        std::string baseline;
+        double threshold = 0.1;
+        bool updateBaseline = false;
+        Format format = Text;
+        std::string junit;
+        Combinations::Coverage coverage = Combinations::Exhaustive;
+        size_t shard = 0;
+        size_t shards = 1;
     } param;
 
 private:
-    void test(const std::string& file, const std::string& func, const std::string& line);
+    typedef std::chrono::steady_clock Clock;
+
+    class Writer;
+
+    struct Message {
+        Return ret;
+        std::string msg;
+        std::string file;
+        std::string func;
+        std::string line;
+    };
+
+    struct Record {
+        Return ret;
+        std::string name;
+        uint64_t ns;
+        uint64_t checkNs;
+        size_t checkLine;
+        std::vector<std::pair<std::string, double>> benches;
+        std::vector<Message> messages;
+    };
+
+    Return message(const Return& ret, const std::string& msg, const std::string& file, const std::string& func, const std::string& line);
+    Return runTest(TestInstanceFunc, const size_t& index);
+    void runParallel();
+    void emitBegin(const size_t& nums);
+    void emit(Record&);
+    void emitEnd(const size_t& pass, const size_t& nott, const size_t& nums);
+    void comment(const std::string& text);
+    Return benchResult(const std::string& name, const size_t& iterations, const uint64_t& ns, const std::string& file, const std::string& func, const std::string& line);
+    void readBaseline();
+    void writeBaseline();
+    void reportSlowest();
 
     struct {
         size_t pass;
@@ -61,8 +156,14 @@ private:
         const size_t sum() const { return pass + fail; }
     } _checks = { 0, 0 };
     const bool _showPass;
+    const size_t _jobs;
     std::set<TestInstanceFunc> _tests;
-    std::stringstream _result;
+    std::unique_ptr<Writer> _out;
+    std::unique_ptr<Writer> _junit;
+    Record _current;
+    Clock::time_point _checkStart;
+    std::vector<Record> _records;
+    std::map<std::string, double> _baseline;
 };
 
 // Api tests.
@@ -74,6 +175,12 @@ void manualTests(TestContext* ctx);
 // Unit tests.
 void unitAndBehaviorTests(TestContext*);
 
+// Tests of arg-parser.h.
+void parserTests(TestContext*);
+
+// Tests of the test harness.
+void harnessTests(TestContext*);
+
 } // namespace testargparse
 
 #endif // TEST_HPP
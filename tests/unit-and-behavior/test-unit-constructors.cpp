@@ -75,13 +75,14 @@ TestContext::Return testInterlacedString(TestContext* ctx)
     TAP_HELP_SHOW_CASES(helpShowCases);
     TAP_VALUE_STR_TEST_CASES(tabCases);
 
-    for (size_t tabCase = 0; tabCase < TAP_ARRAY_SIZE(tabCases); ++tabCase)
-    for (size_t helpShowCase = 0; helpShowCase < TAP_ARRAY_SIZE(helpShowCases); ++helpShowCase)
-    for (size_t helpMarginCase = 0; helpMarginCase < TAP_ARRAY_SIZE(helpMarginCases); ++helpMarginCase)
-    for (size_t helpCompactCase = 0; helpCompactCase < TAP_ARRAY_SIZE(helpCompactCases); ++helpCompactCase)
-    for (size_t helpAddCase = 0; helpAddCase < TAP_ARRAY_SIZE(helpAddCases); ++helpAddCase)
-    for (size_t modeStrictCase = 0; modeStrictCase < TAP_ARRAY_SIZE(modeStrictCases); ++modeStrictCase)
-    for (size_t programNameCase = 0; programNameCase < TAP_ARRAY_SIZE(programNameCases); ++programNameCase) {
+    size_t tabCase, helpShowCase, helpMarginCase, helpCompactCase, helpAddCase, modeStrictCase, programNameCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(tabCase, tabCases),
+                       TAP_CASES(helpShowCase, helpShowCases),
+                       TAP_CASES(helpMarginCase, helpMarginCases),
+                       TAP_CASES(helpCompactCase, helpCompactCases),
+                       TAP_CASES(helpAddCase, helpAddCases),
+                       TAP_CASES(modeStrictCase, modeStrictCases),
+                       TAP_CASES(programNameCase, programNameCases)) {
         const std::string interlacedOptionString =
                 std::string("program.name=") + programNameCases[programNameCase].str
                 + "," + std::string("mode.strict=") + std::to_string((int)modeStrictCases[modeStrictCase].value)
@@ -117,13 +118,14 @@ TestContext::Return testInitializerList(TestContext* ctx)
     TAP_HELP_SHOW_CASES(helpShowCases);
     TAP_VALUE_STR_TEST_CASES(tabCases);
 
-    for (size_t tabCase = 0; tabCase < TAP_ARRAY_SIZE(tabCases); ++tabCase)
-    for (size_t helpShowCase = 0; helpShowCase < TAP_ARRAY_SIZE(helpShowCases); ++helpShowCase)
-    for (size_t helpMarginCase = 0; helpMarginCase < TAP_ARRAY_SIZE(helpMarginCases); ++helpMarginCase)
-    for (size_t helpCompactCase = 0; helpCompactCase < TAP_ARRAY_SIZE(helpCompactCases); ++helpCompactCase)
-    for (size_t helpAddCase = 0; helpAddCase < TAP_ARRAY_SIZE(helpAddCases); ++helpAddCase)
-    for (size_t modeStrictCase = 0; modeStrictCase < TAP_ARRAY_SIZE(modeStrictCases); ++modeStrictCase)
-    for (size_t programNameCase = 0; programNameCase < TAP_ARRAY_SIZE(programNameCases); ++programNameCase) {
+    size_t tabCase, helpShowCase, helpMarginCase, helpCompactCase, helpAddCase, modeStrictCase, programNameCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(tabCase, tabCases),
+                       TAP_CASES(helpShowCase, helpShowCases),
+                       TAP_CASES(helpMarginCase, helpMarginCases),
+                       TAP_CASES(helpCompactCase, helpCompactCases),
+                       TAP_CASES(helpAddCase, helpAddCases),
+                       TAP_CASES(modeStrictCase, modeStrictCases),
+                       TAP_CASES(programNameCase, programNameCases)) {
         ArgParse ap({ std::string("program.name=") + programNameCases[programNameCase].str,
                         std::string("mode.strict=") + std::to_string((int)modeStrictCases[modeStrictCase].value),
                         std::string("help.add=") + std::to_string((int)helpAddCases[helpAddCase].value),
@@ -78,8 +78,8 @@ TestContext::Return testDefFlag(TestContext* ctx)
         { Flag("abc", "s "), { false, true, true } },
     };
 
-    for (size_t callBackFuncCase = 0; callBackFuncCase < TAP_ARRAY_SIZE(callBackFuncCases); ++callBackFuncCase)
-    for (size_t testCase = 0; testCase < TAP_ARRAY_SIZE(testCases); ++testCase) {
+    size_t callBackFuncCase, testCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(callBackFuncCase, callBackFuncCases), TAP_CASES(testCase, testCases)) {
         const CallBackFunc callBackFunc = callBackFuncCases[callBackFuncCase].func;
         const Flag defFlag = testCases[testCase].flag;
         const std::string caseName = TAP_CASE_NAME(testCase, TAP_FLAG_TO_STR(defFlag));
@@ -129,9 +129,8 @@ TestContext::Return testDefArg(TestContext* ctx)
     TAP_REQUIRED_TEST_CASES(requiredCases);
     TAP_VALUE_STR_TEST_CASES(valueStrCases);
 
-    for (size_t nameCase = 0; nameCase < TAP_ARRAY_SIZE(nameCases); ++nameCase)
-    for (size_t requiredCase = 0; requiredCase < TAP_ARRAY_SIZE(requiredCases); ++requiredCase)
-    for (size_t valueStrCase = 0; valueStrCase < TAP_ARRAY_SIZE(valueStrCases); ++valueStrCase) {
+    size_t nameCase, requiredCase, valueStrCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(nameCase, nameCases), TAP_CASES(requiredCase, requiredCases), TAP_CASES(valueStrCase, valueStrCases)) {
         const bool required = requiredCases[requiredCase].required;
         const std:: string testStr = valueStrCases[valueStrCase].str;
         const std:: string testValueName = "value-name";
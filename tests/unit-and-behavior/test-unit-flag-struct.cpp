@@ -41,9 +41,8 @@ TestContext::Return testConstructors(TestContext* ctx)
     TAP_REQUIRED_TEST_CASES(requiredCases);
     TAP_VALUE_STR_TEST_CASES(valueStrCases);
 
-    for (size_t flagCase = 0; flagCase < TAP_ARRAY_SIZE(flagNameCases); ++flagCase)
-    for (size_t requiredCase = 0; requiredCase < TAP_ARRAY_SIZE(requiredCases); ++requiredCase)
-    for (size_t valueStrCase = 0; valueStrCase < TAP_ARRAY_SIZE(valueStrCases); ++valueStrCase) {
+    size_t flagCase, requiredCase, valueStrCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(flagCase, flagNameCases), TAP_CASES(requiredCase, requiredCases), TAP_CASES(valueStrCase, valueStrCases)) {
         const bool required = requiredCases[requiredCase].required;
         const std:: string testStr = valueStrCases[valueStrCase].str;
         const std:: string testValueName = "value-name";
@@ -164,8 +163,8 @@ TestContext::Return testIsValidFunc(TestContext* ctx)
         { "-abcd", false, false },
     };
 
-    for (size_t longFlagStrCase = 0; longFlagStrCase < TAP_ARRAY_SIZE(flagStrCases); ++longFlagStrCase)
-    for (size_t shortFlagStrCase = 0; shortFlagStrCase < TAP_ARRAY_SIZE(flagStrCases); ++shortFlagStrCase) {
+    size_t longFlagStrCase, shortFlagStrCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(longFlagStrCase, flagStrCases), TAP_CASES(shortFlagStrCase, flagStrCases)) {
         const std::string longFlagName = flagStrCases[longFlagStrCase].flagStr;
         const std::string shortFlagName = flagStrCases[shortFlagStrCase].flagStr;
 
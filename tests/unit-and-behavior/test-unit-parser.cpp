@@ -217,9 +217,8 @@ TestContext::Return testParserFunc(TestContext* ctx)
     TAP_REQUIRED_TEST_CASES(requiredCases);
     TAP_FLAGS_NAME_TEST_CASES(flagStrCases, "--long", "-s");
 
-    for (size_t defaultValueCase = 0; defaultValueCase < TAP_ARRAY_SIZE(defaultValueCases); ++defaultValueCase)
-    for (size_t requiredCase = 0; requiredCase < TAP_ARRAY_SIZE(requiredCases); ++requiredCase)
-    for (size_t flagStrCase = 0; flagStrCase < TAP_ARRAY_SIZE(flagStrCases); ++flagStrCase) {
+    size_t defaultValueCase, requiredCase, flagStrCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(defaultValueCase, defaultValueCases), TAP_CASES(requiredCase, requiredCases), TAP_CASES(flagStrCase, flagStrCases)) {
         const std::string defaultValueStr = defaultValueCases[defaultValueCase].str;
         const bool required = requiredCases[requiredCase].required;
 
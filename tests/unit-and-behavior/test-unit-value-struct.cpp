@@ -37,8 +37,8 @@ TestContext::Return testConstructors(TestContext* ctx)
     TAP_REQUIRED_TEST_CASES(requiredCases);
     TAP_VALUE_STR_TEST_CASES(valueStrCases);
 
-    for (size_t requiredCase = 0; requiredCase < TAP_ARRAY_SIZE(requiredCases); ++requiredCase)
-    for (size_t valueStrCase = 0; valueStrCase < TAP_ARRAY_SIZE(valueStrCases); ++valueStrCase) {
+    size_t requiredCase, valueStrCase;
+    TAP_FOR_CASES(ctx, TAP_CASES(requiredCase, requiredCases), TAP_CASES(valueStrCase, valueStrCases)) {
         const bool required = requiredCases[requiredCase].required;
         const std:: string testStr = valueStrCases[valueStrCase].str;
         const std:: string testName = "name";